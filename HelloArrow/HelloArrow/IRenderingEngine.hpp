@@ -23,12 +23,14 @@ enum DeviceOrientation {
 struct IRenderingEngine* CreateRenderEngine1();
 struct IRenderingEngine* CreateRenderEngine2();
 
-// Interface to the OpenGL ES renderer; consumed by GLView.
+// Interface to the OpenGL ES renderer; consumed by GLView.  UpdateAnimation()
+// and OnRotate() return whether they changed what's on screen; GLView only
+// calls Render() for a frame after one of them has.
 struct IRenderingEngine {
     virtual void Initialize(int width, int height) = 0;
     virtual void Render() const = 0;
-    virtual void UpdateAnimation(float timeStep) = 0;
-    virtual void OnRotate(DeviceOrientation newOrientation) = 0;
+    virtual bool UpdateAnimation(float timeStep) = 0;
+    virtual bool OnRotate(DeviceOrientation newOrientation) = 0;
     virtual ~IRenderingEngine() {}
 };
 
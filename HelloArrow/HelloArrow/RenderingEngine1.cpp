@@ -16,8 +16,8 @@ public:
     RenderingEngine1();
     void Initialize(int width, int height);
     void Render() const;
-    void UpdateAnimation(float timeStep);
-    void OnRotate(DeviceOrientation newOrientation);
+    bool UpdateAnimation(float timeStep);
+    bool OnRotate(DeviceOrientation newOrientation);
 private:
     float RotationDirection() const;
     float m_desireAngle;
@@ -102,11 +102,11 @@ void RenderingEngine1::Render() const {
     glPopMatrix();
 }
 
-void RenderingEngine1::UpdateAnimation(float timeStep) {
+bool RenderingEngine1::UpdateAnimation(float timeStep) {
 
     float direction = RotationDirection();
     if (direction == 0) {
-        return;
+        return false;
     }
     
     float degrees = timeStep * 360 * RevolutionsPerSecond;
@@ -123,9 +123,10 @@ void RenderingEngine1::UpdateAnimation(float timeStep) {
     if (RotationDirection() != direction) {
         m_currentAngle = m_desireAngle;
     }
+    return true;
 }
 
-void RenderingEngine1::OnRotate(DeviceOrientation orientation) {
+bool RenderingEngine1::OnRotate(DeviceOrientation orientation) {
 
     float angle = 0;
     
@@ -146,6 +147,7 @@ void RenderingEngine1::OnRotate(DeviceOrientation orientation) {
     }
     
     m_desireAngle = angle;
+    return m_desireAngle != m_currentAngle;
 }
 
 float RenderingEngine1::RotationDirection() const {
@@ -24,8 +24,8 @@ public:
     RenderingEngine2();
     void Initialize(int width, int height);
     void Render() const;
-    void UpdateAnimation(float timeStep);
-    void OnRotate(DeviceOrientation newOrientation);
+    bool UpdateAnimation(float timeStep);
+    bool OnRotate(DeviceOrientation newOrientation);
     
 private:
     float RotationDirection() const;
@@ -118,11 +118,11 @@ void RenderingEngine2::Render() const {
     glDisableVertexAttribArray(colorSlot);
 }
 
-void RenderingEngine2::UpdateAnimation(float timeStep) {
+bool RenderingEngine2::UpdateAnimation(float timeStep) {
 
     float direction = RotationDirection();
     if (direction == 0) {
-        return;
+        return false;
     }
     
     float degrees = timeStep * 360 * RevolutionPerSecond;
@@ -141,9 +141,10 @@ void RenderingEngine2::UpdateAnimation(float timeStep) {
         
         m_currentAngle = m_desiredAngle;
     }
+    return true;
 }
 
-void RenderingEngine2::OnRotate(DeviceOrientation newOrientation) {
+bool RenderingEngine2::OnRotate(DeviceOrientation newOrientation) {
 
     float angle = 0;
     
@@ -165,6 +166,7 @@ void RenderingEngine2::OnRotate(DeviceOrientation newOrientation) {
     }
     
     m_desiredAngle = angle;
+    return m_desiredAngle != m_currentAngle;
 }
 
 float RenderingEngine2::RotationDirection() const {
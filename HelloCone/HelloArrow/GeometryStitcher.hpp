@@ -0,0 +1,92 @@
+//
+//  GeometryStitcher.hpp
+//  HelloCone
+//
+//  Created by zhangdl on 30/5/14.
+//  Copyright (c) 2014 com.*. All rights reserved.
+//
+
+#pragma once
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+// Merges the primitive groups of one object, each written as it would be
+// drawn with glDrawArrays, into one vertex array and one indexed triangle
+// list, so the whole object is a single glDrawElements call.  Anything that
+// differs between groups, like their color, has to be in the vertices.
+// Strips and fans keep their winding.  A triangle with two corners at the
+// same Position, like every other triangle of a strip that repeats its
+// apex, is dropped; Vertex needs a Position that compares with ==.  Indices
+// are 16 bits, so the object must stay below 65536 vertices.
+template <typename Vertex>
+class GeometryStitcher {
+
+public:
+    void AddTriangles(const Vertex* vertices, size_t count);
+    void AddStrip(const Vertex* vertices, size_t count);
+    void AddFan(const Vertex* vertices, size_t count);
+    const std::vector<Vertex>& GetVertices() const { return m_vertices; }
+    const std::vector<unsigned short>& GetIndices() const { return m_indices; }
+
+private:
+    unsigned short Append(const Vertex* vertices, size_t count);
+    void AddTriangle(unsigned short a, unsigned short b, unsigned short c);
+
+    std::vector<Vertex> m_vertices;
+    std::vector<unsigned short> m_indices;
+};
+
+template <typename Vertex>
+inline unsigned short GeometryStitcher<Vertex>::Append(const Vertex* vertices, size_t count) {
+
+    assert(m_vertices.size() + count < 65536 && "too many vertices for 16-bit indices");
+    unsigned short first = m_vertices.size();
+    m_vertices.insert(m_vertices.end(), vertices, vertices + count);
+    return first;
+}
+
+template <typename Vertex>
+inline void GeometryStitcher<Vertex>::AddTriangle(unsigned short a, unsigned short b, unsigned short c) {
+
+    const Vertex* v = &m_vertices[0];
+    if (v[a].Position == v[b].Position || v[b].Position == v[c].Position || v[a].Position == v[c].Position)
+        return;
+    m_indices.push_back(a);
+    m_indices.push_back(b);
+    m_indices.push_back(c);
+}
+
+template <typename Vertex>
+inline void GeometryStitcher<Vertex>::AddTriangles(const Vertex* vertices, size_t count) {
+
+    unsigned short first = Append(vertices, count);
+    for (size_t i = 0; i + 3 <= count; i += 3) {
+        AddTriangle(first + i, first + i + 1, first + i + 2);
+    }
+}
+
+// Every other triangle of a strip is wound the other way, so swap its first
+// two vertices.
+template <typename Vertex>
+inline void GeometryStitcher<Vertex>::AddStrip(const Vertex* vertices, size_t count) {
+
+    unsigned short first = Append(vertices, count);
+    for (size_t i = 0; i + 3 <= count; ++i) {
+
+        unsigned short v = first + i;
+        if (i % 2)
+            AddTriangle(v + 1, v, v + 2);
+        else
+            AddTriangle(v, v + 1, v + 2);
+    }
+}
+
+template <typename Vertex>
+inline void GeometryStitcher<Vertex>::AddFan(const Vertex* vertices, size_t count) {
+
+    unsigned short first = Append(vertices, count);
+    for (size_t i = 1; i + 2 <= count; ++i) {
+        AddTriangle(first, first + i, first + i + 1);
+    }
+}
@@ -0,0 +1,469 @@
+//
+//  ParametricSurface.hpp
+//  HelloCone
+//
+//  Created by zhangdl on 24/5/14.
+//  Copyright (c) 2014 com.*. All rights reserved.
+//
+
+#pragma once
+#include <vector>
+#include "Vector.hpp"
+#include "Trig.hpp"
+#include "ThreadPool.hpp"
+
+// Mesh generators for the usual primitives.  Each surface reports its sizes
+// first, so the caller can allocate once, then writes a welded, indexed
+// triangle list straight into that storage in a single pass: no vertex is
+// written twice and there is no duplicate seam column.  Triangles wind
+// counter-clockwise seen from the side the normals point to.
+//
+//     Sphere sphere(1, 64, 32);
+//     vector<Vertex> vertices(sphere.GetVertexCount());
+//     vector<unsigned> indices(sphere.GetTriangleIndexCount());
+//     sphere.Generate(&vertices[0].Position, &vertices[0].Normal, sizeof(Vertex), &indices[0]);
+//
+// Indices are written 32 bits wide; narrow them for drawing.
+//
+// The work is also split into GetRangeCount() ranges, rows for all of the
+// surfaces here, and GenerateRange() writes just the vertices and indices of
+// ranges [first, last), at the same place in the buffers as Generate() would.
+// Ranges don't share any output, so they can be generated in any order or on
+// several threads and the result is the same, bit for bit.
+struct ISurface {
+    
+    virtual int GetVertexCount() const = 0;
+    virtual int GetTriangleIndexCount() const = 0;
+    virtual int GetRangeCount() const = 0;
+    
+    // Positions and normals are written stride bytes apart; normals may be
+    // null.  Every index is offset by baseVertex, so several surfaces can
+    // share one vertex buffer.
+    void Generate(vec3* positions, vec3* normals, size_t stride,
+                  unsigned* indices, int baseVertex = 0) const {
+        
+        GenerateRange(0, GetRangeCount(), positions, normals, stride, indices, baseVertex);
+    }
+    virtual void GenerateRange(int first, int last, vec3* positions, vec3* normals, size_t stride,
+                               unsigned* indices, int baseVertex = 0) const = 0;
+    virtual ~ISurface() {}
+};
+
+// One row of a surface of revolution about the y axis: a circle of the given
+// radius at height y, whose normals lean out by normalRadius and up by
+// normalY.
+struct ProfilePoint {
+    
+    float radius;
+    float y;
+    float normalRadius;
+    float normalY;
+};
+
+enum RevolvedSurfaceFlags {
+    
+    RevolvedSurfaceClosed = 1,      // the last row joins back to the first
+    RevolvedSurfaceFirstPole = 2,   // the first row is a single point
+    RevolvedSurfaceLastPole = 4,    // the last row is a single point
+    RevolvedSurfaceLastApex = 8,    // the last row is a point with one normal per slice
+};
+
+// Cone, cylinder, sphere, torus and disk are all a profile curve swept around
+// the y axis.  The slice angles come from one SinCosSteps table and each
+// profile row is evaluated once, so a vertex costs a handful of multiplies.
+//
+// Rows are written in profile order, except that a closed surface takes them
+// from both ends in turn (0, n - 1, 1, n - 2, ...) so that every band joins
+// rows at most two apart and stays in one 16-bit index window.  A ring row
+// holds slices vertices at angles k * 2pi / slices for k = 0, 1, ..., at
+// (radius cos, y, radius sin); a pole row holds one vertex on the axis.  An
+// apex row, like the tip of a cone, keeps one vertex per slice so each can
+// have its own normal, but is joined to its neighbour with one triangle per
+// slice.
+//
+// Range i is the i-th row written together with the band from row i to the
+// next one.
+class RevolvedSurface : public ISurface {
+
+public:
+    int GetVertexCount() const;
+    int GetTriangleIndexCount() const;
+    int GetRangeCount() const;
+    void GenerateRange(int first, int last, vec3* positions, vec3* normals, size_t stride,
+                       unsigned* indices, int baseVertex = 0) const;
+
+protected:
+    RevolvedSurface(int slices, int stacks, int flags);
+    
+    // Number of profile rows: stacks + 1, or stacks when closed.
+    int GetRowCount() const;
+    
+    // Fills GetRowCount() rows.
+    virtual void EvaluateProfile(ProfilePoint* rows) const = 0;
+    
+    int m_slices;
+    int m_stacks;
+
+private:
+    bool IsPole(int row) const;
+    bool IsApex(int row) const;
+    int GetRow(int order) const;
+    int GetBandIndexCount(int band) const;
+    
+    int m_flags;
+};
+
+inline RevolvedSurface::RevolvedSurface(int slices, int stacks, int flags)
+    : m_slices(slices), m_stacks(stacks), m_flags(flags) {
+
+}
+
+inline int RevolvedSurface::GetRowCount() const {
+    
+    return (m_flags & RevolvedSurfaceClosed) ? m_stacks : m_stacks + 1;
+}
+
+inline bool RevolvedSurface::IsPole(int row) const {
+    
+    if (row == 0)
+        return (m_flags & RevolvedSurfaceFirstPole) != 0;
+    if (row == GetRowCount() - 1)
+        return (m_flags & RevolvedSurfaceLastPole) != 0;
+    return false;
+}
+
+inline bool RevolvedSurface::IsApex(int row) const {
+    
+    return row == GetRowCount() - 1 && (m_flags & RevolvedSurfaceLastApex) != 0;
+}
+
+// The profile row written order-th.
+inline int RevolvedSurface::GetRow(int order) const {
+    
+    if (!(m_flags & RevolvedSurfaceClosed))
+        return order;
+    return order % 2 ? GetRowCount() - 1 - order / 2 : order / 2;
+}
+
+// Indices for the band from row band to the next; 0 past the last band.
+inline int RevolvedSurface::GetBandIndexCount(int band) const {
+    
+    bool closed = (m_flags & RevolvedSurfaceClosed) != 0;
+    if (band >= (closed ? GetRowCount() : GetRowCount() - 1))
+        return 0;
+    
+    int next = (band + 1) % GetRowCount();
+    bool point = IsPole(band) || IsPole(next) || IsApex(next);
+    return (point ? 3 : 6) * m_slices;
+}
+
+inline int RevolvedSurface::GetVertexCount() const {
+    
+    int count = 0;
+    for (int row = 0; row < GetRowCount(); ++row) {
+        count += IsPole(row) ? 1 : m_slices;
+    }
+    return count;
+}
+
+inline int RevolvedSurface::GetTriangleIndexCount() const {
+    
+    int count = 0;
+    for (int band = 0; band < GetRowCount(); ++band) {
+        count += GetBandIndexCount(band);
+    }
+    return count;
+}
+
+inline int RevolvedSurface::GetRangeCount() const {
+    
+    return GetRowCount();
+}
+
+inline void RevolvedSurface::GenerateRange(int first, int last, vec3* positions, vec3* normals,
+                                           size_t stride, unsigned* indices, int baseVertex) const {
+    
+    int rowCount = GetRowCount();
+    std::vector<ProfilePoint> rows(rowCount);
+    EvaluateProfile(&rows[0]);
+    
+    std::vector<float> sines(m_slices), cosines(m_slices);
+    SinCosSteps(m_slices, &sines[0], &cosines[0], m_slices);
+    
+    // Where each row starts, and where the first band's indices go.
+    std::vector<int> rowStart(rowCount);
+    for (int i = 0, vertex = baseVertex; i < rowCount; ++i) {
+        
+        int row = GetRow(i);
+        rowStart[row] = vertex;
+        vertex += IsPole(row) ? 1 : m_slices;
+    }
+    unsigned* index = indices;
+    for (int band = 0; band < first; ++band) {
+        index += GetBandIndexCount(band);
+    }
+    
+    // Vertices of the rows written first through last - 1.
+    for (int i = first; i < last; ++i) {
+        
+        int row = GetRow(i);
+        const ProfilePoint& p = rows[row];
+        bool pole = IsPole(row);
+        int count = pole ? 1 : m_slices;
+        char* position = (char*) positions + (rowStart[row] - baseVertex) * stride;
+        char* normal = normals ? (char*) normals + (rowStart[row] - baseVertex) * stride : 0;
+        for (int slice = 0; slice < count; ++slice) {
+            
+            float c = pole ? 0 : cosines[slice];
+            float s = pole ? 0 : sines[slice];
+            *(vec3*) position = vec3(p.radius * c, p.y, p.radius * s);
+            position += stride;
+            if (normals) {
+                
+                *(vec3*) normal = vec3(p.normalRadius * c, p.normalY, p.normalRadius * s);
+                normal += stride;
+            }
+        }
+    }
+    
+    // Triangles between each pair of neighbouring rows a and b.
+    for (int band = first; band < last && GetBandIndexCount(band); ++band) {
+        
+        int a = band, b = (band + 1) % rowCount;
+        bool poleA = IsPole(a), poleB = IsPole(b), apexB = IsApex(b);
+        for (int slice = 0; slice < m_slices; ++slice) {
+            
+            int next = (slice + 1) % m_slices;
+            int a0 = rowStart[a] + (poleA ? 0 : slice);
+            int a1 = rowStart[a] + (poleA ? 0 : next);
+            int b0 = rowStart[b] + (poleB ? 0 : slice);
+            int b1 = rowStart[b] + (poleB ? 0 : next);
+            if (!poleA) {
+                
+                *index++ = a0;
+                *index++ = b0;
+                *index++ = a1;
+            }
+            if (!poleB && !apexB) {
+                
+                *index++ = a1;
+                *index++ = b0;
+                *index++ = b1;
+            }
+        }
+    }
+}
+
+// Base on y = 0, apex at y = height.  No base disk; add a Disk for that.
+class Cone : public RevolvedSurface {
+
+public:
+    Cone(float height, float radius, int slices, int stacks)
+        : RevolvedSurface(slices, stacks, RevolvedSurfaceLastApex), m_height(height), m_radius(radius) {
+    
+    }
+
+protected:
+    void EvaluateProfile(ProfilePoint* rows) const {
+        
+        float length = std::sqrt(m_height * m_height + m_radius * m_radius);
+        for (int row = 0; row <= m_stacks; ++row) {
+            
+            float t = (float) row / m_stacks;
+            ProfilePoint p = { m_radius * (1 - t), m_height * t, m_height / length, m_radius / length };
+            rows[row] = p;
+        }
+    }
+
+private:
+    float m_height;
+    float m_radius;
+};
+
+// Open tube from y = 0 to y = height.
+class Cylinder : public RevolvedSurface {
+
+public:
+    Cylinder(float height, float radius, int slices, int stacks)
+        : RevolvedSurface(slices, stacks, 0), m_height(height), m_radius(radius) {
+    
+    }
+
+protected:
+    void EvaluateProfile(ProfilePoint* rows) const {
+        
+        for (int row = 0; row <= m_stacks; ++row) {
+            
+            ProfilePoint p = { m_radius, m_height * row / m_stacks, 1, 0 };
+            rows[row] = p;
+        }
+    }
+
+private:
+    float m_height;
+    float m_radius;
+};
+
+// Centered on the origin, from the south pole to the north pole.
+class Sphere : public RevolvedSurface {
+
+public:
+    Sphere(float radius, int slices, int stacks)
+        : RevolvedSurface(slices, stacks, RevolvedSurfaceFirstPole | RevolvedSurfaceLastPole),
+          m_radius(radius) {
+    
+    }
+
+protected:
+    void EvaluateProfile(ProfilePoint* rows) const {
+        
+        // Row k is k * pi / stacks from the south pole.
+        std::vector<float> sines(m_stacks + 1), cosines(m_stacks + 1);
+        SinCosSteps(2 * m_stacks, &sines[0], &cosines[0], m_stacks + 1);
+        for (int row = 0; row <= m_stacks; ++row) {
+            
+            ProfilePoint p = { m_radius * sines[row], -m_radius * cosines[row], sines[row], -cosines[row] };
+            rows[row] = p;
+        }
+    }
+
+private:
+    float m_radius;
+};
+
+// Lies in the xz plane around the origin.  Stacks go around the tube,
+// starting from its outer equator.
+class Torus : public RevolvedSurface {
+
+public:
+    Torus(float majorRadius, float minorRadius, int slices, int stacks)
+        : RevolvedSurface(slices, stacks, RevolvedSurfaceClosed),
+          m_majorRadius(majorRadius), m_minorRadius(minorRadius) {
+    
+    }
+
+protected:
+    void EvaluateProfile(ProfilePoint* rows) const {
+        
+        std::vector<float> sines(m_stacks), cosines(m_stacks);
+        SinCosSteps(m_stacks, &sines[0], &cosines[0], m_stacks);
+        for (int row = 0; row < m_stacks; ++row) {
+            
+            ProfilePoint p = {
+                m_majorRadius + m_minorRadius * cosines[row], m_minorRadius * sines[row],
+                cosines[row], sines[row],
+            };
+            rows[row] = p;
+        }
+    }
+
+private:
+    float m_majorRadius;
+    float m_minorRadius;
+};
+
+// Flat disk on y = 0 facing down, from the center out to the rim; caps a
+// Cone or the bottom of a Cylinder.
+class Disk : public RevolvedSurface {
+
+public:
+    Disk(float radius, int slices, int stacks)
+        : RevolvedSurface(slices, stacks, RevolvedSurfaceFirstPole), m_radius(radius) {
+    
+    }
+
+protected:
+    void EvaluateProfile(ProfilePoint* rows) const {
+        
+        for (int row = 0; row <= m_stacks; ++row) {
+            
+            ProfilePoint p = { m_radius * row / m_stacks, 0, 0, -1 };
+            rows[row] = p;
+        }
+    }
+
+private:
+    float m_radius;
+};
+
+// Flat width by depth grid on y = 0, centered on the origin and facing up.
+// slices divide it along x and stacks along z; vertices go row by row in z.
+class Grid : public ISurface {
+
+public:
+    Grid(float width, float depth, int slices, int stacks)
+        : m_width(width), m_depth(depth), m_slices(slices), m_stacks(stacks) {
+    
+    }
+    int GetVertexCount() const {
+        
+        return (m_slices + 1) * (m_stacks + 1);
+    }
+    int GetTriangleIndexCount() const {
+        
+        return 6 * m_slices * m_stacks;
+    }
+    // Range i is row i of vertices and the row of quads after it.
+    int GetRangeCount() const {
+        
+        return m_stacks + 1;
+    }
+    void GenerateRange(int first, int last, vec3* positions, vec3* normals, size_t stride,
+                       unsigned* indices, int baseVertex = 0) const {
+        
+        int columns = m_slices + 1;
+        char* position = (char*) positions + first * columns * stride;
+        char* normal = normals ? (char*) normals + first * columns * stride : 0;
+        for (int row = first; row < last; ++row) {
+            
+            float z = m_depth * ((float) row / m_stacks - 0.5f);
+            for (int column = 0; column <= m_slices; ++column) {
+                
+                *(vec3*) position = vec3(m_width * ((float) column / m_slices - 0.5f), 0, z);
+                position += stride;
+                if (normals) {
+                    
+                    *(vec3*) normal = vec3(0, 1, 0);
+                    normal += stride;
+                }
+            }
+        }
+        
+        unsigned* index = indices + 6 * m_slices * first;
+        for (int row = first; row < last && row < m_stacks; ++row) {
+            
+            for (int column = 0; column < m_slices; ++column) {
+                
+                int a = baseVertex + row * columns + column;
+                int b = a + columns;
+                *index++ = a;
+                *index++ = b;
+                *index++ = a + 1;
+                *index++ = a + 1;
+                *index++ = b;
+                *index++ = b + 1;
+            }
+        }
+    }
+
+private:
+    float m_width;
+    float m_depth;
+    int m_slices;
+    int m_stacks;
+};
+
+// Generate() split over the pool's threads, in chunks of roughly
+// VerticesPerChunk vertices.  The output is identical to Generate()'s, and a
+// surface smaller than one chunk is generated on the calling thread.
+const int VerticesPerChunk = 16384;
+
+inline void Generate(const ISurface& surface, ThreadPool& pool, vec3* positions, vec3* normals,
+                     size_t stride, unsigned* indices, int baseVertex = 0) {
+    
+    int ranges = surface.GetRangeCount();
+    int grain = (int) ((long long) VerticesPerChunk * ranges / std::max(surface.GetVertexCount(), 1));
+    pool.ParallelFor(ranges, grain, [&](int first, int last) {
+        surface.GenerateRange(first, last, positions, normals, stride, indices, baseVertex);
+    });
+}
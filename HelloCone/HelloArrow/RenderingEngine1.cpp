@@ -9,6 +9,7 @@
 #include <OpenGLES/ES1/gl.h>
 #include <OpenGLES/ES1/glext.h>
 #include <vector>
+#include "GeometryStitcher.hpp"
 #include "IRenderingEngine.hpp"
 #include "Quaternion.hpp"
 
@@ -37,13 +38,13 @@ public:
     RenderingEngine1();
     void Initialize(int width, int height);
     void Render() const;
-    void UpdateAnimation(float timeStep);
-    void OnRotate(DeviceOrientation newOrientation);
+    bool UpdateAnimation(float timeStep);
+    bool OnRotate(DeviceOrientation newOrientation);
 private:
     Animation m_animation;
     
-    vector<Vertex> m_cone;
-    vector<Vertex> m_disk;
+    vector<Vertex> m_vertices;
+    vector<GLushort> m_indices;
     
     GLuint m_colorRenderbuffer;
     GLuint m_depthRenderbuffer;
@@ -67,12 +68,15 @@ void RenderingEngine1::Initialize(int width, int height) {
     const float coneHeight = 1.866f;
     const int coneSlices = 40;
     
+    vector<Vertex> disk;
+    vector<Vertex> cone;
+    
     {
         //Generate vertices for the disk
-        m_disk.resize(coneSlices + 2);
+        disk.resize(coneSlices + 2);
         
         //Initialize the center vertex of the triangle fan.
-        vector<Vertex>::iterator vertex = m_disk.begin();
+        vector<Vertex>::iterator vertex = disk.begin();
         vertex->Color = vec4(0.75, 0.75, 0.75, 1);
         vertex->Position.x = 0;
         vertex->Position.y = 1 - coneHeight;
@@ -81,7 +85,7 @@ void RenderingEngine1::Initialize(int width, int height) {
         
         //Initialize the rim vertices of the triangle fan.
         const float dtheta = TwoPi / coneSlices;
-        for (float theta = 0; vertex != m_disk.end(); theta += dtheta) {
+        for (float theta = 0; vertex != disk.end(); theta += dtheta) {
             
             vertex->Color = vec4(0.75, 0.75, 0.75, 1);
             vertex->Position.x = coneRadius * cos(theta);
@@ -93,12 +97,12 @@ void RenderingEngine1::Initialize(int width, int height) {
     }
     {
         //Generate vertices for the body of the cone
-        m_cone.resize((coneSlices + 1) * 2);
+        cone.resize((coneSlices + 1) * 2);
         
         //Initialize the vertices of the triangle strip.
-        vector<Vertex>::iterator vertex = m_cone.begin();
+        vector<Vertex>::iterator vertex = cone.begin();
         const float dtheta = TwoPi / coneSlices;
-        for (float theta = 0; vertex != m_cone.end(); theta += dtheta) {
+        for (float theta = 0; vertex != cone.end(); theta += dtheta) {
             
             //Grayscale gradient
             float brightness = abs(sin(theta));
@@ -118,6 +122,13 @@ void RenderingEngine1::Initialize(int width, int height) {
         }
     }
     
+    //Stitch the disk's fan and the body's strip into one triangle list
+    GeometryStitcher<Vertex> stitcher;
+    stitcher.AddFan(&disk[0], disk.size());
+    stitcher.AddStrip(&cone[0], cone.size());
+    m_vertices = stitcher.GetVertices();
+    m_indices = stitcher.GetIndices();
+    
     //Create the depth buffer
     glGenRenderbuffersOES(1, &m_depthRenderbuffer);
     glBindRenderbufferOES(GL_RENDERBUFFER_OES, m_depthRenderbuffer);
@@ -163,15 +174,10 @@ void RenderingEngine1::Render() const {
     mat4 rotation(m_animation.Current.ToMatrix());
     glMultMatrixf(rotation.Pointer());
     
-    //Draw the cone.
-    glVertexPointer(3, GL_FLOAT, sizeof(Vertex), &m_cone[0].Position.x);
-    glColorPointer(4, GL_FLOAT, sizeof(Vertex), &m_cone[0].Color.x);
-    glDrawArrays(GL_TRIANGLE_STRIP, 0, m_cone.size());
-    
-    //Draw the disk that caps off the base of the cone.
-    glVertexPointer(3, GL_FLOAT, sizeof(Vertex), &m_disk[0].Position.x);
-    glColorPointer(4, GL_FLOAT, sizeof(Vertex), &m_disk[0].Color.x);
-    glDrawArrays(GL_TRIANGLE_FAN, 0, m_disk.size());
+    //Draw the cone and the disk that caps off its base in one call.
+    glVertexPointer(3, GL_FLOAT, sizeof(Vertex), &m_vertices[0].Position.x);
+    glColorPointer(4, GL_FLOAT, sizeof(Vertex), &m_vertices[0].Color.x);
+    glDrawElements(GL_TRIANGLES, m_indices.size(), GL_UNSIGNED_SHORT, &m_indices[0]);
     
     glDisableClientState(GL_VERTEX_ARRAY);
     glDisableClientState(GL_COLOR_ARRAY);
@@ -179,11 +185,11 @@ void RenderingEngine1::Render() const {
     glPopMatrix();
 }
 
-void RenderingEngine1::UpdateAnimation(float timeStep) {
+bool RenderingEngine1::UpdateAnimation(float timeStep) {
 
     if (m_animation.Current == m_animation.End) {
         
-        return;
+        return false;
     }
     
     m_animation.Elapsed += timeStep;
@@ -195,9 +201,10 @@ void RenderingEngine1::UpdateAnimation(float timeStep) {
         float mu = m_animation.Elapsed / AnimationDuration;
         m_animation.Current = m_animation.Start.Slerp(mu, m_animation.End);
     }
+    return true;
 }
 
-void RenderingEngine1::OnRotate(DeviceOrientation orientation) {
+bool RenderingEngine1::OnRotate(DeviceOrientation orientation) {
 
     vec3 direction;
     
@@ -234,6 +241,7 @@ void RenderingEngine1::OnRotate(DeviceOrientation orientation) {
     m_animation.Elapsed = 0;
     m_animation.Start = m_animation.Current = m_animation.End;
     m_animation.End = Quaternion::CreateFromVectors(vec3(0, 1, 0), direction);
+    return true;
 }
 
 
@@ -6,11 +6,13 @@
 //  Copyright (c) 2014 com.*. All rights reserved.
 //
 
+#include <algorithm>
 #include <cmath>
 #include <iostream>
 #include <OpenGLES/ES2/gl.h>
 #include <OpenGLES/ES2/glext.h>
 #include <vector>
+#include "ParametricSurface.hpp"
 #include "Quaternion.hpp"
 #include "IRenderingEngine.hpp"
 
@@ -43,15 +45,15 @@ public:
     RenderingEngine2();
     void Initialize(int width, int height);
     void Render() const;
-    void UpdateAnimation(float timeStep);
-    void OnRotate(DeviceOrientation newOrientation);
+    bool UpdateAnimation(float timeStep);
+    bool OnRotate(DeviceOrientation newOrientation);
     
 private:
     GLuint BuildShader(const char* source, GLenum shaderType) const;
     GLuint BuildProgram(const char* vShader, const char* fShader) const;
     Animation m_animation;
-    vector<Vertex> m_cone;
-    vector<Vertex> m_disk;
+    vector<Vertex> m_vertices;
+    vector<GLushort> m_indices;
     GLuint m_colorRenderbuffer;
     GLuint m_depthRenderbuffer;
     GLuint m_framebuffer;
@@ -76,56 +78,39 @@ void RenderingEngine2::Initialize(int width, int height) {
     const float coneHeight = 1.866f;
     const int coneSlices = 40;
     
-    {
+    //Generate the body and the disk that caps its base into one vertex array
+    //and one triangle list, so the whole cone is a single draw call
+    Cone cone(coneHeight, coneRadius, coneSlices, 1);
+    Disk disk(coneRadius, coneSlices, 1);
+    const int diskVertex = cone.GetVertexCount();
+    const int diskIndex = cone.GetTriangleIndexCount();
+    m_vertices.resize(diskVertex + disk.GetVertexCount());
+    vector<unsigned> indices(diskIndex + disk.GetTriangleIndexCount());
+    cone.Generate(&m_vertices[0].Position, 0, sizeof(Vertex), &indices[0]);
+    disk.Generate(&m_vertices[diskVertex].Position, 0, sizeof(Vertex), &indices[diskIndex], diskVertex);
     
-        //Generate vertices for the apex
-        m_cone.resize(2 * (coneSlices + 1));
-        
-        //Initialize the vertices of the triangle strip
-        vector<Vertex>::iterator vertex = m_cone.begin();
-        const float dtheta = TwoPi / coneSlices;
-        
-        for (float theta = 0; vertex != m_cone.end(); theta += dtheta) {
-            
-            //Grayscale gradient
-            float brightness = abs(sin(theta));
-            vec4 color(brightness, brightness, brightness, 1);
-            
-            //Apex vertex
-            vertex->Position = vec3(0, 1, 0);
-            vertex->Color = color;
-            vertex++;
-            
-            //Rim vertex
-            vertex->Position.x = coneRadius * cos(theta);
-            vertex->Position.y = 1 - coneHeight;
-            vertex->Position.z = coneRadius * sin(theta);
-            vertex->Color = color;
-            vertex++;
-        }
+    //Cone winds the body to face out, but this cone has always been wound
+    //apex, rim, next rim; swap the first two of each triangle to keep that
+    for (int i = 0; i < diskIndex; i += 3) {
+        swap(indices[i], indices[i + 1]);
     }
+    m_indices.assign(indices.begin(), indices.end());
     
-    {
-        //Generate vertices for the disk
-        m_disk.resize(coneSlices + 2);
-        
-        vector<Vertex>::iterator vertex = m_disk.begin();
-        vertex->Color = vec4(0.75, 0.75, 0.75, 1);
-        vertex->Position.x = 0;
-        vertex->Position.y = 1 - coneHeight;
-        vertex->Position.z = 0;
-        vertex++;
+    //Grayscale gradient on the body, the disk in gray.  The strip gave each
+    //triangle the apex one slice on, so the apex row takes its color from
+    //there.  The generated cone stands on y = 0; lift it to put the apex at
+    //y = 1.
+    vector<float> sines(coneSlices), cosines(coneSlices);
+    SinCosSteps(coneSlices, &sines[0], &cosines[0], coneSlices);
+    for (int i = 0; i < (int) m_vertices.size(); ++i) {
         
-        //Initialize the rim vertices of the triangle fan
-        const float dtheta = TwoPi / coneSlices;
-        for (float theta = 0; vertex != m_disk.end(); theta += dtheta) {
-            
-            vertex->Color = vec4(0.75, 0.75, 0.75, 1);
-            vertex->Position.x = coneRadius * cos(theta);
-            vertex->Position.y = 1 - coneHeight;
-            vertex->Position.z = coneRadius * sin(theta);
-            vertex++;
-        }
+        float brightness = 0.75f;
+        if (i < coneSlices)
+            brightness = abs(sines[i]);
+        else if (i < diskVertex)
+            brightness = abs(sines[(i + 1) % coneSlices]);
+        m_vertices[i].Color = vec4(brightness, brightness, brightness, 1);
+        m_vertices[i].Position.y += 1 - coneHeight;
     }
     
     //Create depth buffer
@@ -184,35 +169,22 @@ void RenderingEngine2::Render() const {
     mat4 modelviewMatrix = rotation * translation;
     glUniformMatrix4fv(modelViewUniform, 1, 0, modelviewMatrix.Pointer());
     
-    //Draw the cone.
-    {
-    
-        GLsizei stride = sizeof(Vertex);
-        const GLvoid* pCoords = &m_cone[0].Position.x;
-        const GLvoid* pColors = &m_cone[0].Color.x;
-        glVertexAttribPointer(positionSlot, 3, GL_FLOAT, GL_FALSE, stride, pCoords);
-        glVertexAttribPointer(colorSlot, 4, GL_FLOAT, GL_FALSE, stride, pColors);
-        glDrawArrays(GL_TRIANGLE_STRIP, 0, m_cone.size());
-    }
-    
-    //Draw the disk that caps off the base of the cone.
-    {
-        GLsizei stride = sizeof(Vertex);
-        const GLvoid* pCoords = &m_disk[0].Position.x;
-        const GLvoid* pColors = &m_disk[0].Color.x;
-        glVertexAttribPointer(positionSlot, 3, GL_FLOAT, GL_FALSE, stride, pCoords);
-        glVertexAttribPointer(colorSlot, 4, GL_FLOAT, GL_FALSE, stride, pColors);
-        glDrawArrays(GL_TRIANGLE_FAN, 0, m_disk.size());
-    }
+    //Draw the cone and the disk that caps off its base in one call.
+    GLsizei stride = sizeof(Vertex);
+    const GLvoid* pCoords = &m_vertices[0].Position.x;
+    const GLvoid* pColors = &m_vertices[0].Color.x;
+    glVertexAttribPointer(positionSlot, 3, GL_FLOAT, GL_FALSE, stride, pCoords);
+    glVertexAttribPointer(colorSlot, 4, GL_FLOAT, GL_FALSE, stride, pColors);
+    glDrawElements(GL_TRIANGLES, m_indices.size(), GL_UNSIGNED_SHORT, &m_indices[0]);
     
     glDisableVertexAttribArray(positionSlot);
     glDisableVertexAttribArray(colorSlot);
 }
 
-void RenderingEngine2::UpdateAnimation(float timeStep) {
+bool RenderingEngine2::UpdateAnimation(float timeStep) {
 
     if (m_animation.Current == m_animation.End) {
-        return;
+        return false;
     }
     
     m_animation.Elapsed += timeStep;
@@ -224,9 +196,10 @@ void RenderingEngine2::UpdateAnimation(float timeStep) {
         float mu = m_animation.Elapsed / AnimationDuration;
         m_animation.Current = m_animation.Start.Slerp(mu, m_animation.End);
     }
+    return true;
 }
 
-void RenderingEngine2::OnRotate(DeviceOrientation newOrientation) {
+bool RenderingEngine2::OnRotate(DeviceOrientation newOrientation) {
 
     vec3 direction;
     
@@ -262,6 +235,7 @@ void RenderingEngine2::OnRotate(DeviceOrientation newOrientation) {
     m_animation.Elapsed = 0;
     m_animation.Start = m_animation.Current = m_animation.End;
     m_animation.End = Quaternion::CreateFromVectors(vec3(0, 1, 0), direction);
+    return true;
 }
 
 
@@ -0,0 +1,183 @@
+//
+//  Trig.hpp
+//  HelloCone
+//
+//  Created by zhangdl on 20/5/14.
+//  Copyright (c) 2014 com.*. All rights reserved.
+//
+
+#pragma once
+#include <cmath>
+#include <cstddef>
+#include "Simd.hpp"
+
+// Sine and cosine from one shared range reduction.  The argument is reduced
+// to [-pi/4, pi/4] with a three-part pi/2 (Cody-Waite), then both polynomials
+// are evaluated and swapped or negated by quadrant.
+//
+// TrigPrecisionAccurate uses the Cephes sinf/cosf minimax polynomials and is
+// within 1e-7 of std::sin/std::cos for |x| < 8192.  TrigPrecisionFast drops
+// two terms and is within 2e-5, which is plenty for vertex positions.
+enum TrigPrecision {
+
+    TrigPrecisionFast,
+    TrigPrecisionAccurate,
+};
+
+namespace Trig {
+
+const float TwoOverPi = 0.636619772367581343f;
+const float HalfPi1 = 1.5703125f;
+const float HalfPi2 = 4.83751296997070312e-4f;
+const float HalfPi3 = 7.54978995489188216e-8f;
+
+inline void Polynomials(float r, TrigPrecision precision, float& s, float& c) {
+
+    float r2 = r * r;
+    if (precision == TrigPrecisionAccurate) {
+
+        s = r + r * r2 * (-1.6666654611e-1f + r2 * (8.3321608736e-3f + r2 * -1.9515295891e-4f));
+        c = 1 - 0.5f * r2 + r2 * r2 * (4.166664568298827e-2f + r2 * (-1.388731625493765e-3f + r2 * 2.443315711809948e-5f));
+    } else {
+
+        s = r + r * r2 * (-0.166627561f + r2 * 0.00815158945f);
+        c = 1 + r2 * (-0.499772580f + r2 * 0.0404819928f);
+    }
+}
+
+inline void Polynomials(Simd::float4 r, TrigPrecision precision, Simd::float4& s, Simd::float4& c) {
+
+    using namespace Simd;
+    float4 r2 = Mul(r, r);
+    float4 r3 = Mul(r, r2);
+    if (precision == TrigPrecisionAccurate) {
+
+        float4 ps = MulAdd(r2, Splat(-1.9515295891e-4f), Splat(8.3321608736e-3f));
+        ps = MulAdd(r2, ps, Splat(-1.6666654611e-1f));
+        s = MulAdd(r3, ps, r);
+
+        float4 pc = MulAdd(r2, Splat(2.443315711809948e-5f), Splat(-1.388731625493765e-3f));
+        pc = MulAdd(r2, pc, Splat(4.166664568298827e-2f));
+        c = MulAdd(Mul(r2, r2), pc, Sub(Splat(1), Mul(Splat(0.5f), r2)));
+    } else {
+
+        s = MulAdd(r3, MulAdd(r2, Splat(0.00815158945f), Splat(-0.166627561f)), r);
+        c = MulAdd(r2, MulAdd(r2, Splat(0.0404819928f), Splat(-0.499772580f)), Splat(1));
+    }
+}
+
+// Rotates (s, c) by quadrant * pi/2.
+inline void ApplyQuadrant(int quadrant, float& s, float& c) {
+
+    float rs = s, rc = c;
+    switch (quadrant & 3) {
+        case 0: s = rs;  c = rc;  break;
+        case 1: s = rc;  c = -rs; break;
+        case 2: s = -rs; c = -rc; break;
+        case 3: s = -rc; c = rs;  break;
+    }
+}
+
+// Same, with whole-number quadrants held in floats so it can be done with
+// multiplies instead of masks.
+inline void ApplyQuadrant(Simd::float4 j, Simd::float4& s, Simd::float4& c) {
+
+    using namespace Simd;
+    float4 one = Splat(1);
+    float4 two = Splat(2);
+
+    // q = j mod 4, then split into bits: b0 swaps sine and cosine, b1
+    // negates the sine and b0 ^ b1 negates the cosine.
+    float4 q = Sub(j, Mul(Splat(4), Round(Mul(Sub(j, Splat(1.5f)), Splat(0.25f)))));
+    float4 b1 = Round(Mul(Sub(q, Splat(0.5f)), Splat(0.5f)));
+    float4 b0 = Sub(q, Mul(two, b1));
+    float4 nb0 = Sub(one, b0);
+
+    float4 sinBase = Add(Mul(s, nb0), Mul(c, b0));
+    float4 cosBase = Add(Mul(c, nb0), Mul(s, b0));
+    float4 cosFlip = Sub(Add(b0, b1), Mul(two, Mul(b0, b1)));
+    s = Mul(sinBase, Sub(one, Mul(two, b1)));
+    c = Mul(cosBase, Sub(one, Mul(two, cosFlip)));
+}
+
+}
+
+inline void SinCos(float radians, float& s, float& c, TrigPrecision precision = TrigPrecisionAccurate) {
+
+    float j = std::floor(radians * Trig::TwoOverPi + 0.5f);
+    float r = ((radians - j * Trig::HalfPi1) - j * Trig::HalfPi2) - j * Trig::HalfPi3;
+    Trig::Polynomials(r, precision, s, c);
+    Trig::ApplyQuadrant((int)j, s, c);
+}
+
+inline void SinCos(Simd::float4 radians, Simd::float4& s, Simd::float4& c, TrigPrecision precision = TrigPrecisionAccurate) {
+
+    using namespace Simd;
+    float4 j = Round(Mul(radians, Splat(Trig::TwoOverPi)));
+    float4 r = Sub(radians, Mul(j, Splat(Trig::HalfPi1)));
+    r = Sub(r, Mul(j, Splat(Trig::HalfPi2)));
+    r = Sub(r, Mul(j, Splat(Trig::HalfPi3)));
+    Trig::Polynomials(r, precision, s, c);
+    Trig::ApplyQuadrant(j, s, c);
+}
+
+// s[i], c[i] = sin and cos of radians[i], four at a time.
+inline void SinCos(const float* radians, float* s, float* c, size_t count,
+                   TrigPrecision precision = TrigPrecisionAccurate) {
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+
+        Simd::float4 vs, vc;
+        SinCos(Simd::Load(radians + i), vs, vc, precision);
+        Simd::Store(s + i, vs);
+        Simd::Store(c + i, vc);
+    }
+    for (; i < count; ++i) {
+        SinCos(radians[i], s[i], c[i], precision);
+    }
+}
+
+// Sine and cosine of k * 2pi / steps for k in [0, count), for laying out
+// rings and slices.  Each angle is reduced exactly in integers instead of
+// being accumulated, so quarter turns land on exact 0 and +-1, mirrored
+// slices get bit-identical values and k == steps closes the ring exactly.
+inline void SinCosSteps(int steps, float* s, float* c, size_t count,
+                        TrigPrecision precision = TrigPrecisionAccurate) {
+
+    const float scale = 1.57079632679489662f / steps;
+    float r[4], q[4];
+
+    for (size_t i = 0; i < count; i += 4) {
+
+        size_t n = (count - i < 4) ? count - i : 4;
+        for (size_t k = 0; k < 4; ++k) {
+
+            // 4k / steps quarter turns, rounded to the nearest quadrant with
+            // ties to even so that k and steps - k reduce to mirror images.
+            long m = 4 * (long)(i + (k < n ? k : 0));
+            long quadrant = m / steps;
+            long rest = m % steps;
+            if (2 * rest > steps || (2 * rest == steps && (quadrant & 1))) {
+
+                quadrant++;
+                rest -= steps;
+            }
+            r[k] = rest * scale;
+            q[k] = (float)(quadrant & 3);
+        }
+
+        Simd::float4 vs, vc;
+        Trig::Polynomials(Simd::Load(r), precision, vs, vc);
+        Trig::ApplyQuadrant(Simd::Load(q), vs, vc);
+
+        float ts[4], tc[4];
+        Simd::Store(ts, vs);
+        Simd::Store(tc, vc);
+        for (size_t k = 0; k < n; ++k) {
+
+            s[i + k] = ts[k];
+            c[i + k] = tc[k];
+        }
+    }
+}
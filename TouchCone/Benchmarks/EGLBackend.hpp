@@ -0,0 +1,197 @@
+//
+//  EGLBackend.hpp
+//  TouchCone
+//
+//  Created by zhangdl on 4/6/14.
+//  Copyright (c) 2014 com.*. All rights reserved.
+//
+
+#pragma once
+#include <dlfcn.h>
+#include <stdint.h>
+#include "GLDispatch.hpp"
+
+// An OpenGL ES context with no window, for filling the dispatch table of
+// GLDispatch.hpp with a real implementation.  EGL and GLES are opened with
+// dlopen, so building needs neither and a machine without them only fails
+// Create().  Mesa's surfaceless platform is tried first and needs no display
+// server; with no GPU, Mesa draws in software.  The engines draw into
+// framebuffer objects of their own, so the context's surface is a 1 x 1
+// pbuffer that's never looked at.
+class EGLBackend {
+
+public:
+    EGLBackend();
+    ~EGLBackend();
+    
+    // Makes an ES version 1 or 2 context current on this thread and loads
+    // its functions into the dispatch table.  Entries the library doesn't
+    // have are left as LoadNullGL() sets them.  Returns false with a reason
+    // in GetError() when there's no EGL or no such context.
+    bool Create(int version);
+    const char* GetError() const { return m_error; }
+
+private:
+    EGLBackend(const EGLBackend&);
+    EGLBackend& operator = (const EGLBackend&);
+    
+    typedef void* Display;
+    typedef void* Config;
+    typedef void* Surface;
+    typedef void* Context;
+    typedef int32_t Int;
+    typedef unsigned Boolean;
+    typedef void (*Function)();
+    
+    enum {
+        
+        None = 0x3038,
+        SurfaceType = 0x3033,
+        PbufferBit = 0x0001,
+        RenderableType = 0x3040,
+        OpenGLES1Bit = 0x0001,
+        OpenGLES2Bit = 0x0004,
+        RedSize = 0x3024,
+        GreenSize = 0x3023,
+        BlueSize = 0x3022,
+        DepthSize = 0x3025,
+        Width = 0x3057,
+        Height = 0x3056,
+        ContextClientVersion = 0x3098,
+        OpenGLESAPI = 0x30A0,
+        PlatformSurfacelessMesa = 0x31DD,
+    };
+    
+    bool Fail(const char* error);
+    void Destroy();
+    template <typename F> bool Load(F& function, const char* name);
+    
+    void* m_egl;
+    void* m_gles;
+    Display m_display;
+    Surface m_surface;
+    Context m_context;
+    const char* m_error;
+    
+    Function (*m_getProcAddress)(const char*);
+    Display (*m_getPlatformDisplay)(unsigned, void*, const intptr_t*);
+    Display (*m_getDisplay)(void*);
+    Boolean (*m_initialize)(Display, Int*, Int*);
+    Boolean (*m_bindAPI)(unsigned);
+    Boolean (*m_chooseConfig)(Display, const Int*, Config*, Int, Int*);
+    Surface (*m_createPbufferSurface)(Display, Config, const Int*);
+    Context (*m_createContext)(Display, Config, Context, const Int*);
+    Boolean (*m_makeCurrent)(Display, Surface, Surface, Context);
+    Boolean (*m_destroyContext)(Display, Context);
+    Boolean (*m_destroySurface)(Display, Surface);
+    Boolean (*m_terminate)(Display);
+};
+
+inline EGLBackend::EGLBackend() : m_egl(0), m_gles(0), m_display(0), m_surface(0), m_context(0), m_error("") {
+
+}
+
+inline EGLBackend::~EGLBackend() {
+    
+    Destroy();
+}
+
+inline bool EGLBackend::Fail(const char* error) {
+    
+    m_error = error;
+    Destroy();
+    return false;
+}
+
+inline void EGLBackend::Destroy() {
+    
+    if (m_display) {
+        
+        m_makeCurrent(m_display, 0, 0, 0);
+        if (m_context)
+            m_destroyContext(m_display, m_context);
+        if (m_surface)
+            m_destroySurface(m_display, m_surface);
+        m_terminate(m_display);
+    }
+    if (m_gles)
+        dlclose(m_gles);
+    if (m_egl)
+        dlclose(m_egl);
+    m_egl = m_gles = m_display = m_surface = m_context = 0;
+}
+
+// From libEGL itself, else from eglGetProcAddress.
+template <typename F>
+inline bool EGLBackend::Load(F& function, const char* name) {
+    
+    void* address = dlsym(m_egl, name);
+    function = address ? reinterpret_cast<F>(address) : reinterpret_cast<F>(m_getProcAddress(name));
+    return function != 0;
+}
+
+inline bool EGLBackend::Create(int version) {
+    
+    Destroy();
+    m_egl = dlopen("libEGL.so.1", RTLD_NOW | RTLD_LOCAL);
+    if (!m_egl)
+        return Fail("no libEGL.so.1");
+    m_getProcAddress = reinterpret_cast<Function (*)(const char*)>(dlsym(m_egl, "eglGetProcAddress"));
+    if (!m_getProcAddress || !Load(m_getDisplay, "eglGetDisplay") || !Load(m_initialize, "eglInitialize") ||
+        !Load(m_bindAPI, "eglBindAPI") || !Load(m_chooseConfig, "eglChooseConfig") ||
+        !Load(m_createPbufferSurface, "eglCreatePbufferSurface") || !Load(m_createContext, "eglCreateContext") ||
+        !Load(m_makeCurrent, "eglMakeCurrent") || !Load(m_destroyContext, "eglDestroyContext") ||
+        !Load(m_destroySurface, "eglDestroySurface") || !Load(m_terminate, "eglTerminate"))
+        return Fail("libEGL.so.1 is missing functions");
+    Load(m_getPlatformDisplay, "eglGetPlatformDisplayEXT");
+    
+    // Surfaceless first, then whatever the default display is
+    Int major, minor;
+    if (m_getPlatformDisplay)
+        m_display = m_getPlatformDisplay(PlatformSurfacelessMesa, 0, 0);
+    if (m_display && !m_initialize(m_display, &major, &minor))
+        m_display = 0;
+    if (!m_display) {
+        
+        m_display = m_getDisplay(0);
+        if (m_display && !m_initialize(m_display, &major, &minor))
+            m_display = 0;
+    }
+    if (!m_display)
+        return Fail("no EGL display");
+    
+    const Int configAttributes[] = {
+        SurfaceType, PbufferBit,
+        RenderableType, version == 1 ? OpenGLES1Bit : OpenGLES2Bit,
+        RedSize, 5, GreenSize, 6, BlueSize, 5, DepthSize, 16,
+        None
+    };
+    const Int surfaceAttributes[] = { Width, 1, Height, 1, None };
+    const Int contextAttributes[] = { ContextClientVersion, version, None };
+    Config config;
+    Int configCount = 0;
+    if (!m_bindAPI(OpenGLESAPI) || !m_chooseConfig(m_display, configAttributes, &config, 1, &configCount) ||
+        !configCount)
+        return Fail("no EGL config for that OpenGL ES version");
+    m_surface = m_createPbufferSurface(m_display, config, surfaceAttributes);
+    m_context = m_createContext(m_display, config, 0, contextAttributes);
+    if (!m_surface || !m_context || !m_makeCurrent(m_display, m_surface, m_surface, m_context))
+        return Fail("couldn't make an OpenGL ES context current");
+    
+    // Core functions are exported by the library; extensions, like ES1's
+    // framebuffer objects, only come from eglGetProcAddress.
+    m_gles = dlopen(version == 1 ? "libGLESv1_CM.so.1" : "libGLESv2.so.2", RTLD_NOW | RTLD_LOCAL);
+    if (!m_gles)
+        return Fail(version == 1 ? "no libGLESv1_CM.so.1" : "no libGLESv2.so.2");
+    
+    LoadNullGL();
+    GLDispatch& dispatch = GetGLDispatch();
+    #define GL_DISPATCH_LOAD(R, name, parameters) \
+        if (void* address = dlsym(m_gles, "gl" #name)) \
+            dispatch.name = reinterpret_cast<decltype(dispatch.name)>(address); \
+        else if (Function address = m_getProcAddress("gl" #name)) \
+            dispatch.name = reinterpret_cast<decltype(dispatch.name)>(address);
+    GL_DISPATCH_FUNCTIONS(GL_DISPATCH_LOAD)
+    #undef GL_DISPATCH_LOAD
+    return true;
+}
@@ -0,0 +1,108 @@
+//
+//  GenerateBenchmark.cpp
+//  TouchCone
+//
+//  Created by zhangdl on 28/5/14.
+//  Copyright (c) 2014 com.*. All rights reserved.
+//
+//  How parallel mesh generation scales with the number of threads.  Builds
+//  like MathBenchmark:
+//
+//      c++ -std=c++11 -O2 -pthread -I../TouchCone GenerateBenchmark.cpp -o GenerateBenchmark
+//      ./GenerateBenchmark [max threads]
+//
+//  Every run is compared against the serial Generate(), so a mismatch in
+//  the last column means the ranges don't add up to the same mesh.
+//
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include "ParametricSurface.hpp"
+
+using namespace std;
+
+static const int RunCount = 7;              // the best run is reported
+
+struct Vertex {
+    
+    vec3 Position;
+    vec3 Normal;
+};
+
+struct Mesh {
+    
+    vector<Vertex> Vertices;
+    vector<unsigned> Indices;
+    
+    explicit Mesh(const ISurface& surface)
+        : Vertices(surface.GetVertexCount()), Indices(surface.GetTriangleIndexCount()) {
+        
+    }
+    bool operator == (const Mesh& b) const {
+        
+        return !memcmp(&Vertices[0], &b.Vertices[0], Vertices.size() * sizeof(Vertex)) &&
+               !memcmp(&Indices[0], &b.Indices[0], Indices.size() * sizeof(unsigned));
+    }
+};
+
+// Fastest of RunCount runs, in milliseconds.
+static double Measure(const ISurface& surface, ThreadPool& pool, Mesh& mesh) {
+    
+    typedef chrono::steady_clock Clock;
+    
+    double best = 1e30;
+    for (int run = 0; run < RunCount; ++run) {
+        
+        Clock::time_point start = Clock::now();
+        Generate(surface, pool, &mesh.Vertices[0].Position, &mesh.Vertices[0].Normal,
+                 sizeof(Vertex), &mesh.Indices[0]);
+        double ms = chrono::duration<double, milli>(Clock::now() - start).count();
+        best = min(best, ms);
+    }
+    return best;
+}
+
+int main(int argc, char* argv[]) {
+    
+    unsigned cores = max(thread::hardware_concurrency(), 1u);
+    unsigned maxThreads = argc > 1 ? (unsigned) atoi(argv[1]) : cores;
+    printf("%u hardware threads, best of %d runs\n\n", cores, RunCount);
+    
+    struct Case {
+        
+        const char* Name;
+        const ISurface* Surface;
+    };
+    Sphere sphere(1, 1024, 512);
+    Torus torus(1, 0.25f, 1024, 512);
+    Grid grid(1, 1, 1024, 512);
+    const Case cases[] = {
+        { "Sphere 1024 x 512", &sphere },
+        { "Torus 1024 x 512", &torus },
+        { "Grid 1024 x 512", &grid },
+    };
+    
+    printf("%-20s %8s %10s %9s %9s\n", "surface", "threads", "ms", "speedup", "matches");
+    for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); ++c) {
+        
+        const ISurface& surface = *cases[c].Surface;
+        Mesh serial(surface);
+        surface.Generate(&serial.Vertices[0].Position, &serial.Vertices[0].Normal,
+                         sizeof(Vertex), &serial.Indices[0]);
+        
+        double single = 0;
+        for (unsigned threads = 1; threads <= maxThreads; threads *= 2) {
+            
+            ThreadPool pool(threads);
+            Mesh mesh(surface);
+            double ms = Measure(surface, pool, mesh);
+            single = threads == 1 ? ms : single;
+            printf("%-20s %8u %10.2f %8.2fx %9s\n", cases[c].Name, threads, ms, single / ms,
+                   mesh == serial ? "yes" : "NO");
+        }
+    }
+    return 0;
+}
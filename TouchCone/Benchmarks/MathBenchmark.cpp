@@ -0,0 +1,373 @@
+//
+//  MathBenchmark.cpp
+//  TouchCone
+//
+//  Created by zhangdl on 22/5/14.
+//  Copyright (c) 2014 com.*. All rights reserved.
+//
+//  Micro-benchmarks for the header-only math library.  Builds anywhere with a
+//  C++11 compiler, no GL needed:
+//
+//      c++ -std=c++11 -O2 -I../TouchCone MathBenchmark.cpp -o MathBenchmark
+//      ./MathBenchmark [filter]
+//
+//  Add -DVECTORMATH_SCALAR to time the portable code paths.  Inputs come from
+//  a fixed-seed generator, so two runs (or two builds) see the same data and
+//  the checksum column shows whether an optimization changed any results.
+//
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include "Frustum.hpp"
+#include "ParametricSurface.hpp"
+#include "Quaternion.hpp"
+
+using namespace std;
+
+static const size_t ElementCount = 1024;    // small enough to stay in L1/L2
+static const int RunCount = 7;              // the best run is reported
+static const size_t BoneCount = 32;
+
+// xorshift32, so the inputs don't depend on the standard library's rand().
+class Random {
+    
+public:
+    explicit Random(unsigned seed) : m_state(seed) {}
+    
+    float Next() {
+        
+        m_state ^= m_state << 13;
+        m_state ^= m_state >> 17;
+        m_state ^= m_state << 5;
+        return (m_state >> 8) * (2.0f / 16777216.0f) - 1;
+    }
+    vec3 NextVec3() { float x = Next(), y = Next(); return vec3(x, y, Next()); }
+    vec4 NextVec4() { float x = Next(), y = Next(), z = Next(); return vec4(x, y, z, Next()); }
+    mat4 NextMat4() {
+        
+        vec4 x = NextVec4(), y = NextVec4(), z = NextVec4();
+        return mat4(x, y, z, NextVec4());
+    }
+    Quaternion NextQuaternion() {
+        
+        float x = Next(), y = Next(), z = Next();
+        Quaternion q(x, y, z, Next());
+        q.Normalize();
+        return q;
+    }
+    
+private:
+    unsigned m_state;
+};
+
+// Order-dependent hash of the result bits.  Taken after timing, but because
+// the results are read back the compiler can't discard the work either.
+static unsigned Checksum(const void* data, size_t size) {
+    
+    const unsigned char* bytes = (const unsigned char*) data;
+    unsigned hash = 2166136261u;
+    for (size_t i = 0; i < size; ++i) {
+        hash = (hash ^ bytes[i]) * 16777619u;
+    }
+    return hash;
+}
+
+struct Inputs {
+    
+    vector<mat4> Matrices;
+    vector<mat4> OtherMatrices;
+    vector<vec4> Vectors4;
+    vector<vec3> Vectors3;
+    vector<vec3> OtherVectors3;
+    vector<Quaternion> Quaternions;
+    vector<Quaternion> OtherQuaternions;
+    vector<float> Scalars;
+    vector<DualQuaternion> Bones;
+    vector<vec4> DualQuaternionPalette;
+    vector<vec4> MatrixPalette;
+    vector<ubvec4> BoneIndices;
+    vector<vec4> BoneWeights;
+    vector<float> Bounds[6];        // center x, y, z and extents or radius
+    vec4 Planes[FrustumPlaneCount];
+    
+    Inputs() {
+        
+        Random random(0x2545F491u);
+        for (size_t i = 0; i < ElementCount; ++i) {
+            
+            Matrices.push_back(random.NextMat4());
+            OtherMatrices.push_back(random.NextMat4());
+            Vectors4.push_back(random.NextVec4());
+            Vectors3.push_back(random.NextVec3());
+            OtherVectors3.push_back(random.NextVec3());
+            Quaternions.push_back(random.NextQuaternion());
+            OtherQuaternions.push_back(random.NextQuaternion());
+            Scalars.push_back(random.Next() * 0.5f + 0.5f);
+            
+            unsigned bones[4];
+            float weights[4], sum = 0;
+            for (int k = 0; k < 4; ++k) {
+                
+                bones[k] = (unsigned) ((random.Next() + 1) * 0.5f * (BoneCount - 1));
+                weights[k] = random.Next() + 1;
+                sum += weights[k];
+            }
+            BoneIndices.push_back(ubvec4(bones[0], bones[1], bones[2], bones[3]));
+            BoneWeights.push_back(vec4(weights[0] / sum, weights[1] / sum, weights[2] / sum, weights[3] / sum));
+            
+            for (int k = 0; k < 6; ++k) {
+                Bounds[k].push_back(k < 3 ? random.Next() * 10 : random.Next() + 1);
+            }
+        }
+        
+        // About a quarter of the bounds end up visible.
+        mat4 view = mat4::Translate(0, 0, -4);
+        ExtractFrustumPlanes(view * mat4::Frustum(-1, 1, -1, 1, 2, 12), Planes);
+        
+        vector<affine3> matrices;
+        for (size_t i = 0; i < BoneCount; ++i) {
+            
+            Bones.push_back(DualQuaternion(random.NextQuaternion(), random.NextVec3()));
+            matrices.push_back(affine3(Bones.back().ToMatrix()));
+        }
+        DualQuaternionPalette.resize(2 * BoneCount);
+        MatrixPalette.resize(3 * BoneCount);
+        PackPalette(&Bones[0], BoneCount, &DualQuaternionPalette[0]);
+        PackPalette(&matrices[0], BoneCount, &MatrixPalette[0]);
+    }
+};
+
+struct Results {
+    
+    const void* Data;
+    size_t Size;
+};
+
+// Each kernel processes all ElementCount inputs once and returns the buffer
+// it wrote.
+typedef Results (*Kernel)(const Inputs& in);
+
+template <typename T, typename Op>
+static Results Run(Op op) {
+    
+    static vector<T> out(ElementCount);
+    for (size_t i = 0; i < ElementCount; ++i) {
+        out[i] = op(i);
+    }
+    Results results = { &out[0], out.size() * sizeof(T) };
+    return results;
+}
+
+static Results MatrixMultiply(const Inputs& in) {
+    
+    return Run<mat4>([&](size_t i) { return in.Matrices[i] * in.OtherMatrices[i]; });
+}
+
+static Results MatrixVector(const Inputs& in) {
+    
+    return Run<vec4>([&](size_t i) { return in.Matrices[i] * in.Vectors4[i]; });
+}
+
+static Results MatrixTransposed(const Inputs& in) {
+    
+    return Run<mat4>([&](size_t i) { return in.Matrices[i].Transposed(); });
+}
+
+static Results MatrixToMat3(const Inputs& in) {
+    
+    return Run<mat3>([&](size_t i) { return in.Matrices[i].ToMat3(); });
+}
+
+static Results QuaternionSlerp(const Inputs& in) {
+    
+    return Run<Quaternion>([&](size_t i) { return in.Quaternions[i].Slerp(in.Scalars[i], in.OtherQuaternions[i]); });
+}
+
+static Results QuaternionRotated(const Inputs& in) {
+    
+    return Run<Quaternion>([&](size_t i) { return in.Quaternions[i].Rotated(in.OtherQuaternions[i]); });
+}
+
+static Results QuaternionToMatrix(const Inputs& in) {
+    
+    return Run<mat3>([&](size_t i) { return in.Quaternions[i].ToMatrix(); });
+}
+
+static Results QuaternionFromVectors(const Inputs& in) {
+    
+    return Run<Quaternion>([&](size_t i) {
+        
+        vec3 v0 = in.Vectors3[i], v1 = in.OtherVectors3[i];
+        v0.Normalize();
+        v1.Normalize();
+        return Quaternion::CreateFromVectors(v0, v1);
+    });
+}
+
+static Results VectorNormalize(const Inputs& in) {
+    
+    return Run<vec3>([&](size_t i) { vec3 v = in.Vectors3[i]; v.Normalize(); return v; });
+}
+
+static Results VectorCross(const Inputs& in) {
+    
+    return Run<vec3>([&](size_t i) { return in.Vectors3[i].Cross(in.OtherVectors3[i]); });
+}
+
+static Results VectorDot(const Inputs& in) {
+    
+    return Run<float>([&](size_t i) { return in.Vectors3[i].Dot(in.OtherVectors3[i]); });
+}
+
+// Four influences per vertex, positions and normals.
+static Results SkinDualQuaternionScalar(const Inputs& in) {
+    
+    static vector<vec3> normals(ElementCount);
+    return Run<vec3>([&](size_t i) {
+        
+        const uint8_t* b = &in.BoneIndices[i].x;
+        DualQuaternion q[4] = { in.Bones[b[0]], in.Bones[b[1]], in.Bones[b[2]], in.Bones[b[3]] };
+        DualQuaternion blend = DualQuaternion::Blend(q, &in.BoneWeights[i].x, 4);
+        normals[i] = blend.TransformVector(in.OtherVectors3[i]);
+        return blend.TransformPoint(in.Vectors3[i]);
+    });
+}
+
+static Results Skin(Skinning method, const vector<vec4>& palette, const Inputs& in) {
+    
+    static vector<vec3> positions(ElementCount), normals(ElementCount);
+    SkinVertices(method, &palette[0], &in.BoneIndices[0], &in.BoneWeights[0],
+                 &in.Vectors3[0], &in.OtherVectors3[0], &positions[0], &normals[0], ElementCount);
+    Results results = { &positions[0], positions.size() * sizeof(vec3) };
+    return results;
+}
+
+static Results SkinDualQuaternion(const Inputs& in) {
+    
+    return Skin(SkinningDualQuaternion, in.DualQuaternionPalette, in);
+}
+
+static Results SkinMatrix(const Inputs& in) {
+    
+    return Skin(SkinningMatrix, in.MatrixPalette, in);
+}
+
+static Results SphereCulling(const Inputs& in) {
+    
+    static vector<uint32_t> visible((ElementCount + 31) / 32);
+    CullSpheres(in.Planes, &in.Bounds[0][0], &in.Bounds[1][0], &in.Bounds[2][0], &in.Bounds[3][0],
+                &visible[0], ElementCount);
+    Results results = { &visible[0], visible.size() * sizeof(uint32_t) };
+    return results;
+}
+
+static Results BoxCulling(const Inputs& in) {
+    
+    static vector<uint32_t> visible((ElementCount + 31) / 32);
+    CullBoxes(in.Planes, &in.Bounds[0][0], &in.Bounds[1][0], &in.Bounds[2][0],
+              &in.Bounds[3][0], &in.Bounds[4][0], &in.Bounds[5][0], &visible[0], ElementCount);
+    Results results = { &visible[0], visible.size() * sizeof(uint32_t) };
+    return results;
+}
+
+// A 32 x 32 torus has exactly ElementCount vertices, so this is per vertex.
+static Results TorusGenerate(const Inputs&) {
+    
+    static const Torus torus(1, 0.25f, 32, 32);
+    static vector<vec3> vertices(2 * ElementCount);
+    static vector<unsigned> indices(torus.GetTriangleIndexCount());
+    torus.Generate(&vertices[0], &vertices[1], 2 * sizeof(vec3), &indices[0]);
+    Results results = { &vertices[0], vertices.size() * sizeof(vec3) };
+    return results;
+}
+
+struct Benchmark {
+    
+    const char* Name;
+    Kernel Function;
+};
+
+static const Benchmark Benchmarks[] = {
+    
+    { "mat4 * mat4", MatrixMultiply },
+    { "mat4 * vec4", MatrixVector },
+    { "mat4::Transposed", MatrixTransposed },
+    { "mat4::ToMat3", MatrixToMat3 },
+    { "Quaternion::Slerp", QuaternionSlerp },
+    { "Quaternion::Rotated", QuaternionRotated },
+    { "Quaternion::ToMatrix", QuaternionToMatrix },
+    { "Quaternion::CreateFromVectors", QuaternionFromVectors },
+    { "vec3::Normalize", VectorNormalize },
+    { "vec3::Cross", VectorCross },
+    { "vec3::Dot", VectorDot },
+    { "skin, DualQuaternion::Blend", SkinDualQuaternionScalar },
+    { "skin, dual quaternion palette", SkinDualQuaternion },
+    { "skin, matrix palette", SkinMatrix },
+    { "cull spheres", SphereCulling },
+    { "cull boxes", BoxCulling },
+    { "Torus::Generate", TorusGenerate },
+};
+
+// Repeats the kernel until a run takes at least ~20ms, then keeps the
+// fastest of RunCount runs.
+static double Measure(Kernel kernel, const Inputs& in, unsigned& checksum) {
+    
+    typedef chrono::steady_clock Clock;
+    
+    int repeats = 1;
+    for (;;) {
+        
+        Clock::time_point start = Clock::now();
+        for (int r = 0; r < repeats; ++r) {
+            kernel(in);
+        }
+        if (Clock::now() - start > chrono::milliseconds(20))
+            break;
+        repeats *= 2;
+    }
+    
+    double best = 1e30;
+    for (int run = 0; run < RunCount; ++run) {
+        
+        Clock::time_point start = Clock::now();
+        for (int r = 0; r < repeats; ++r) {
+            kernel(in);
+        }
+        double ns = chrono::duration<double, nano>(Clock::now() - start).count();
+        best = min(best, ns / ((double) repeats * ElementCount));
+    }
+    
+    Results results = kernel(in);
+    checksum = Checksum(results.Data, results.Size);
+    return best;
+}
+
+int main(int argc, char* argv[]) {
+    
+    const char* filter = argc > 1 ? argv[1] : "";
+    Inputs inputs;
+    
+#if defined(VECTORMATH_SSE)
+    const char* backend = "SSE2";
+#elif defined(VECTORMATH_NEON)
+    const char* backend = "NEON";
+#else
+    const char* backend = "scalar";
+#endif
+    printf("backend: %s, %zu elements, best of %d runs\n\n", backend, ElementCount, RunCount);
+    printf("%-32s %10s %12s %10s\n", "benchmark", "ns/op", "Mop/s", "checksum");
+    
+    for (size_t i = 0; i < sizeof(Benchmarks) / sizeof(Benchmarks[0]); ++i) {
+        
+        const Benchmark& benchmark = Benchmarks[i];
+        if (!strstr(benchmark.Name, filter))
+            continue;
+        
+        unsigned checksum = 0;
+        double ns = Measure(benchmark.Function, inputs, checksum);
+        printf("%-32s %10.2f %12.1f %10.8x\n", benchmark.Name, ns, 1000 / ns, checksum);
+    }
+    return 0;
+}
@@ -0,0 +1,150 @@
+//
+//  RecordBenchmark.cpp
+//  TouchCone
+//
+//  Created by zhangdl on 6/6/14.
+//  Copyright (c) 2014 com.*. All rights reserved.
+//
+//  How RenderQueue::Record scales with the number of threads, on a frame of
+//  many objects.  The engine records a single cone, so RenderBenchmark can't
+//  show it.  Built by CMakeLists.txt, or like GenerateBenchmark with the
+//  null GL backend:
+//
+//      c++ -std=c++11 -O2 -pthread -DGLDISPATCH -I../TouchCone RecordBenchmark.cpp -o RecordBenchmark -ldl
+//      ./RecordBenchmark [objects] [max threads]
+//
+//  Each object does what RenderingEngine2::RecordCone does: makes its
+//  model-view matrix and submits a body and a disk packet.  Record and Sort
+//  are timed apart, since only Record runs on the pool.  Every run's sorted
+//  order is compared against the single-thread run's, so a mismatch in the
+//  last column means the order depends on the thread count.
+//
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include "GLDispatch.hpp"
+#include "RenderQueue.hpp"
+
+using namespace std;
+
+static const int RunCount = 7;              // the best run is reported
+static const int Grain = 64;                // objects per command list
+
+struct Scene {
+    
+    Program programs[2];
+    BufferHandle vertices[4];
+    BufferHandle indices;
+    mat4 view;
+};
+
+// Object i's packets depend only on i.  A packet's vertexOffset is its
+// identity.
+static void RecordObject(const Scene& scene, int i, CommandList& list) {
+    
+    float x = (float) (i % 97) - 48;
+    float z = (float) (i / 97 % 89) + 5;
+    vec3 axis(0.6f, 0.8f, 0);
+    mat4 model = mat4::Scale(0.5f + (i % 5) * 0.125f) * mat4::Rotate((float) (i % 360), axis) *
+                 mat4::Translate(x, (float) (i % 7) - 3, -z);
+    mat4 modelview = model * scene.view;
+    
+    DrawPacket packet = {};
+    packet.program = &scene.programs[i % 2];
+    packet.vertices = scene.vertices[i % 4];
+    packet.vertexOffset = 2 * i;
+    packet.indices = scene.indices;
+    packet.type = IndexTypeShort;
+    packet.count = 240;
+    packet.uniforms[0].uniform = 0;
+    memcpy(packet.uniforms[0].values, modelview.Pointer(), sizeof(packet.uniforms[0].values));
+    packet.uniformCount = 1;
+    packet.depthTest = true;
+    packet.depthWrite = i % 8 != 0;
+    packet.blend = i % 8 != 0 ? BlendNone : BlendAlpha;
+    packet.depth = -modelview.w.z;
+    list.Submit(packet);
+    
+    packet.vertexOffset = 2 * i + 1;
+    packet.count = 120;
+    list.Submit(packet);
+}
+
+static vector<GLintptr> Order(const RenderQueue& queue) {
+    
+    vector<GLintptr> order;
+    for (size_t i = 0; i < queue.GetPacketCount(); ++i) {
+        order.push_back(queue.GetPacket(i).vertexOffset);
+    }
+    return order;
+}
+
+// Fastest of RunCount runs of each step, in milliseconds.
+static void Measure(const Scene& scene, ThreadPool& pool, RenderQueue& queue, int count,
+                    double& record, double& sort) {
+    
+    typedef chrono::steady_clock Clock;
+    
+    record = sort = 1e30;
+    for (int run = 0; run < RunCount; ++run) {
+        
+        Clock::time_point start = Clock::now();
+        queue.Clear();
+        queue.Record(pool, count, Grain, [&scene](int begin, int end, CommandList& list) {
+            
+            for (int i = begin; i < end; ++i) {
+                RecordObject(scene, i, list);
+            }
+        });
+        Clock::time_point recorded = Clock::now();
+        queue.Sort();
+        Clock::time_point sorted = Clock::now();
+        record = min(record, chrono::duration<double, milli>(recorded - start).count());
+        sort = min(sort, chrono::duration<double, milli>(sorted - recorded).count());
+    }
+}
+
+int main(int argc, char* argv[]) {
+    
+    unsigned cores = max(thread::hardware_concurrency(), 1u);
+    int count = argc > 1 ? atoi(argv[1]) : 20000;
+    unsigned maxThreads = argc > 2 ? (unsigned) atoi(argv[2]) : cores;
+    printf("%u hardware threads, %d objects, best of %d runs\n\n", cores, count, RunCount);
+    
+    LoadNullGL();
+    GLState state;
+    BufferManager buffers(state);
+    Scene scene;
+    for (int p = 0; p < 2; ++p) {
+        scene.programs[p].Attach(glCreateProgram());
+    }
+    vector<unsigned char> data(BufferManager::BlockSize * 3 / 4);
+    for (int v = 0; v < 4; ++v) {
+        scene.vertices[v] = buffers.Upload(GL_ARRAY_BUFFER, &data[0], data.size());
+    }
+    scene.indices = buffers.Upload(GL_ELEMENT_ARRAY_BUFFER, &data[0], data.size());
+    scene.view = mat4::Rotate(30, vec3(1, 0, 0)) * mat4::Translate(0, 0, -10);
+    
+    RenderQueue queue(buffers);
+    vector<GLintptr> serial;
+    double single = 0;
+    printf("%8s %12s %9s %10s %9s\n", "threads", "record ms", "speedup", "sort ms", "matches");
+    for (unsigned threads = 1; threads <= maxThreads; threads *= 2) {
+        
+        ThreadPool pool(threads);
+        double record, sort;
+        Measure(scene, pool, queue, count, record, sort);
+        if (threads == 1) {
+            
+            single = record;
+            serial = Order(queue);
+        }
+        printf("%8u %12.3f %8.2fx %10.3f %9s\n", threads, record, single / record, sort,
+               Order(queue) == serial ? "yes" : "NO");
+    }
+    return 0;
+}
@@ -0,0 +1,157 @@
+//
+//  RenderBenchmark.cpp
+//  TouchCone
+//
+//  Created by zhangdl on 4/6/14.
+//  Copyright (c) 2014 com.*. All rights reserved.
+//
+//  Frames of the real rendering engines with no window, so they can be timed
+//  on Linux.  Needs the engines built with GLDISPATCH, which CMakeLists.txt
+//  does:
+//
+//      cmake -S .. -B build && cmake --build build
+//      build/RenderBenchmark [null|egl] [1|2] [frames]
+//
+//  null calls no GL at all, so the time left is the engine's own: culling,
+//  recording, sorting and state filtering.  egl draws with the system's
+//  OpenGL ES through EGLBackend.hpp, which is Mesa's software rasterizer on
+//  a machine without a GPU.  Each frame drags a finger a step around the
+//  cone, like GLView delivering a touch, then renders and waits for GL to
+//  finish.  The checksum is of the last frame's pixels, so two runs (or two
+//  builds) can be checked for drawing the same thing.
+//
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdint.h>
+#include <vector>
+#include "EGLBackend.hpp"
+#include "GLDispatch.hpp"
+#include "IRenderingEngine.hpp"
+
+using namespace std;
+
+static const int Width = 320;
+static const int Height = 480;
+static const int WarmUpFrameCount = 10;     // not timed or counted
+
+// FNV-1a over the framebuffer, read back as RGBA bytes.
+static uint32_t Checksum() {
+    
+    vector<GLubyte> pixels(Width * Height * 4);
+    glReadPixels(0, 0, Width, Height, GL_RGBA, GL_UNSIGNED_BYTE, &pixels[0]);
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < pixels.size(); ++i) {
+        hash = (hash ^ pixels[i]) * 16777619u;
+    }
+    return hash;
+}
+
+// The touch for frame i: a finger a third of the way out, going round.
+static ivec2 Finger(int i) {
+    
+    float angle = i * 0.05f;
+    return ivec2(Width / 2 + (int) (Width / 3 * cos(angle)), Height / 2 + (int) (Width / 3 * sin(angle)));
+}
+
+int main(int argc, char* argv[]) {
+    
+    bool egl = argc > 1 && !strcmp(argv[1], "egl");
+    int version = argc > 2 ? atoi(argv[2]) : 2;
+    int frameCount = argc > 3 ? atoi(argv[3]) : 500;
+    if ((argc > 1 && !egl && strcmp(argv[1], "null")) || (version != 1 && version != 2) || frameCount < 1) {
+        
+        fprintf(stderr, "usage: %s [null|egl] [1|2] [frames]\n", argv[0]);
+        return 1;
+    }
+    
+    EGLBackend backend;
+    if (!egl) {
+        
+        LoadNullGL();
+    } else if (!backend.Create(version)) {
+        
+        fprintf(stderr, "EGL: %s\n", backend.GetError());
+        return 1;
+    }
+    CountGLCalls();
+    printf("OpenGL ES %d on %s, %d x %d, %d frames\n", version, (const char*) glGetString(GL_RENDERER),
+           Width, Height, frameCount);
+    
+    // What GLView does with the context's renderbufferStorage:fromDrawable:
+    IRenderingEngine* engine = version == 1 ? CreateRenderEngine1() : CreateRenderEngine2(0);
+    if (version == 1)
+        glRenderbufferStorageOES(GL_RENDERBUFFER_OES, GL_RGB565_OES, Width, Height);
+    else
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_RGB565, Width, Height);
+    engine->Initialize(Width, Height);
+    GLenum status = version == 1 ? glCheckFramebufferStatusOES(GL_FRAMEBUFFER_OES)
+                                 : glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    if (status != GL_FRAMEBUFFER_COMPLETE) {
+        
+        fprintf(stderr, "framebuffer incomplete: 0x%x\n", status);
+        return 1;
+    }
+    RenderingStats stats = engine->GetStats();
+    printf("%u vertices%s", stats.MeshVertexCount, stats.MeshFromCache ? " from the mesh cache" : "");
+    if (stats.MeshACMRAfter > 0)
+        printf(", ACMR %.3f -> %.3f", stats.MeshACMRBefore, stats.MeshACMRAfter);
+    printf("\n");
+    
+    typedef chrono::steady_clock Clock;
+    
+    vector<double> times;
+    engine->OnFingerDown(Finger(0));
+    for (int i = 1; i <= WarmUpFrameCount + frameCount; ++i) {
+        
+        if (i == WarmUpFrameCount + 1)
+            memset(GetGLCallCounts().calls, 0, sizeof(GetGLCallCounts().calls));
+        
+        Clock::time_point start = Clock::now();
+        engine->OnFingerMove(Finger(i - 1), Finger(i));
+        engine->UpdateAnimation(1.0f / 60);
+        engine->Render();
+        glFinish();
+        if (i > WarmUpFrameCount)
+            times.push_back(chrono::duration<double, milli>(Clock::now() - start).count());
+    }
+    
+    // Counted before the read back adds its own calls
+    const unsigned* calls = GetGLCallCounts().calls;
+    vector<int> functions;
+    unsigned total = 0;
+    for (int f = 0; f < GLFunctionCount; ++f) {
+        
+        total += calls[f];
+        if (calls[f])
+            functions.push_back(f);
+    }
+    sort(functions.begin(), functions.end(), [calls](int a, int b) { return calls[a] > calls[b]; });
+    
+    sort(times.begin(), times.end());
+    double sum = 0;
+    for (size_t i = 0; i < times.size(); ++i) {
+        sum += times[i];
+    }
+    printf("\n%-12s %10s %10s %10s %10s\n", "ms / frame", "mean", "best", "median", "worst");
+    printf("%-12s %10.3f %10.3f %10.3f %10.3f\n", "", sum / times.size(), times.front(),
+           times[times.size() / 2], times.back());
+    
+    printf("\n%-32s %10.1f\n", "GL calls / frame", (double) total / frameCount);
+    for (size_t i = 0; i < functions.size(); ++i) {
+        printf("    %-28s %10.1f\n", GetGLFunctionName(functions[i]), (double) calls[functions[i]] / frameCount);
+    }
+    
+    // The engine's own filtering, of the last frame
+    stats = engine->GetStats();
+    printf("\n%-32s %10u\n", "GL state changes / frame", stats.StateCallCount);
+    printf("    %-28s %10u\n", "filtered", stats.StateFilteredCount);
+    printf("\nchecksum %08x\n", Checksum());
+    
+    delete engine;
+    return 0;
+}
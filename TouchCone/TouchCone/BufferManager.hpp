@@ -0,0 +1,117 @@
+//
+//  BufferManager.hpp
+//  TouchCone
+//
+//  Created by zhangdl on 31/5/14.
+//  Copyright (c) 2014 com.*. All rights reserved.
+//
+
+#pragma once
+#include <cstddef>
+#include <vector>
+#include "GLES2.hpp"
+#include "GLState.hpp"
+
+typedef unsigned BufferHandle;
+
+// Static geometry in GPU buffer objects.  Each upload is copied once into a
+// range of a shared block, a vertex or an index buffer of at least
+// BlockSize bytes, and later drawn by handle, so the driver no longer copies
+// client arrays on every draw.  Vertex and index data never share a block.
+// Ranges live as long as the manager; nothing is freed on its own.  Buffers
+// are bound through state, which drops binds of what's already bound.
+class BufferManager {
+
+public:
+    static const GLsizeiptr BlockSize = 256 * 1024;
+    static const GLsizeiptr Alignment = 4;
+    
+    explicit BufferManager(GLState& state);
+    ~BufferManager();
+    
+    // target is GL_ARRAY_BUFFER or GL_ELEMENT_ARRAY_BUFFER.
+    BufferHandle Upload(GLenum target, const void* data, GLsizeiptr size);
+    
+    // Binds the handle's block and returns the range's offset as the pointer
+    // glVertexAttribPointer and glDrawElements expect while a buffer is bound.
+    const GLvoid* Bind(BufferHandle handle) const;
+    
+    // The block a handle's range is in.  Ranges in the same block draw
+    // without rebinding.
+    size_t GetBlock(BufferHandle handle) const { return m_ranges[handle].block; }
+    
+    size_t GetBlockCount() const { return m_blocks.size(); }
+    GLenum GetBlockTarget(size_t block) const { return m_blocks[block].target; }
+    GLsizeiptr GetBlockSize(size_t block) const { return m_blocks[block].size; }
+    GLsizeiptr GetBlockUsage(size_t block) const { return m_blocks[block].used; }
+
+private:
+    BufferManager(const BufferManager&);
+    BufferManager& operator = (const BufferManager&);
+    
+    struct Block {
+        
+        GLenum target;
+        GLuint buffer;
+        GLsizeiptr size;
+        GLsizeiptr used;
+    };
+    struct Range {
+        
+        size_t block;
+        GLintptr offset;
+    };
+    
+    GLState& m_state;
+    std::vector<Block> m_blocks;
+    std::vector<Range> m_ranges;
+};
+
+inline BufferManager::BufferManager(GLState& state) : m_state(state) {
+
+}
+
+inline BufferManager::~BufferManager() {
+    
+    for (size_t i = 0; i < m_blocks.size(); ++i) {
+        m_state.DeleteBuffer(m_blocks[i].buffer);
+    }
+}
+
+inline BufferHandle BufferManager::Upload(GLenum target, const void* data, GLsizeiptr size) {
+    
+    // First block of this kind with room, else a new one
+    size_t block = 0;
+    for (; block < m_blocks.size(); ++block) {
+        
+        const Block& b = m_blocks[block];
+        if (b.target == target && b.size - b.used >= size)
+            break;
+    }
+    if (block == m_blocks.size()) {
+        
+        Block b = { target, 0, size > BlockSize ? size : BlockSize, 0 };
+        glGenBuffers(1, &b.buffer);
+        m_state.BindBuffer(target, b.buffer);
+        glBufferData(target, b.size, 0, GL_STATIC_DRAW);
+        m_blocks.push_back(b);
+    }
+    
+    Block& b = m_blocks[block];
+    Range range = { block, b.used };
+    m_state.BindBuffer(target, b.buffer);
+    glBufferSubData(target, range.offset, size, data);
+    b.used = (b.used + size + Alignment - 1) / Alignment * Alignment;
+    b.used = b.used < b.size ? b.used : b.size;
+    
+    m_ranges.push_back(range);
+    return m_ranges.size() - 1;
+}
+
+inline const GLvoid* BufferManager::Bind(BufferHandle handle) const {
+    
+    const Range& range = m_ranges[handle];
+    const Block& block = m_blocks[range.block];
+    m_state.BindBuffer(block.target, block.buffer);
+    return (const GLvoid*) range.offset;
+}
@@ -0,0 +1,176 @@
+//
+//  Frustum.hpp
+//  TouchCone
+//
+//  Created by zhangdl on 23/5/14.
+//  Copyright (c) 2014 com.*. All rights reserved.
+//
+
+#pragma once
+#include <stdint.h>
+#include "Matrix.hpp"
+
+// View-frustum culling.  A plane is stored as vec4(n, d) with n unit length,
+// so n.Dot(p) + d is the signed distance of p, positive on the inside.
+enum FrustumPlane {
+    
+    FrustumLeft,
+    FrustumRight,
+    FrustumBottom,
+    FrustumTop,
+    FrustumNear,
+    FrustumFar,
+    FrustumPlaneCount,
+};
+
+// Gribb and Hartmann's extraction ("Fast Extraction of Viewing Frustum
+// Planes from the World-View-Projection Matrix", 2001).  m is the matrix the
+// vertex shader would apply, e.g. view * projection in this library's order,
+// and the planes come out in the space m maps from.
+inline void ExtractFrustumPlanes(const mat4& m, vec4* planes) {
+    
+    // Row k of the clip transform, as the shader sees it after upload.
+    vec4 rows[4];
+    for (int k = 0; k < 4; ++k) {
+        
+        const float* c = &m.x.x + k;
+        rows[k] = vec4(c[0], c[4], c[8], c[12]);
+    }
+    for (int i = 0; i < 3; ++i) {
+        
+        planes[2 * i] = rows[3] + rows[i];
+        planes[2 * i + 1] = rows[3] - rows[i];
+    }
+    for (int i = 0; i < FrustumPlaneCount; ++i) {
+        
+        vec4& p = planes[i];
+        p = p * (1 / std::sqrt(p.x * p.x + p.y * p.y + p.z * p.z));
+    }
+}
+
+// Batch tests over structure-of-arrays bounds, four per vector op.  Bit
+// (i % 32) of visible[i / 32] is set when object i intersects or is inside
+// the frustum; the bits past count in the last word are cleared.  Like all
+// plane tests these are conservative: a few objects near the frustum's
+// corners pass without being visible.  The test reads the sign bit of the
+// smallest distance, so an object exactly touching a plane passes at +0.0
+// but is culled if the distance rounds to -0.0.
+inline void CullSpheres(const vec4* planes,
+                        const float* x, const float* y, const float* z, const float* radius,
+                        uint32_t* visible, size_t count) {
+    
+    using namespace Simd;
+    const float* src[4] = { x, y, z, radius };
+    float4 p[FrustumPlaneCount][4];
+    for (int k = 0; k < FrustumPlaneCount; ++k) {
+        
+        const float* plane = &planes[k].x;
+        for (int c = 0; c < 4; ++c) {
+            p[k][c] = Splat(plane[c]);
+        }
+    }
+    
+    float tail[4][4];
+    for (size_t i = 0; i < count; i += 4) {
+        
+        float4 v[4];
+        size_t used = count - i < 4 ? count - i : 4;
+        if (used == 4) {
+            
+            for (int c = 0; c < 4; ++c) {
+                v[c] = Load(src[c] + i);
+            }
+        } else {
+            
+            for (int c = 0; c < 4; ++c) {
+                
+                for (size_t j = 0; j < 4; ++j) {
+                    tail[c][j] = j < used ? src[c][i + j] : 0;
+                }
+                v[c] = Load(tail[c]);
+            }
+        }
+        
+        // Smallest of dot(n, center) + d + radius over the six planes.
+        float4 nearest = Splat(1);
+        for (int k = 0; k < FrustumPlaneCount; ++k) {
+            
+            float4 d = MulAdd(v[0], p[k][0], Add(p[k][3], v[3]));
+            d = MulAdd(v[1], p[k][1], d);
+            d = MulAdd(v[2], p[k][2], d);
+            nearest = Min(nearest, d);
+        }
+        
+        uint32_t bits = ~SignMask(nearest) & ((1u << used) - 1);
+        if (i % 32 == 0)
+            visible[i / 32] = 0;
+        visible[i / 32] |= bits << (i % 32);
+    }
+}
+
+// Axis-aligned boxes given by center and half-extents.  The extents are
+// projected onto each plane normal to get the box's effective radius.
+inline void CullBoxes(const vec4* planes,
+                      const float* centerX, const float* centerY, const float* centerZ,
+                      const float* extentX, const float* extentY, const float* extentZ,
+                      uint32_t* visible, size_t count) {
+    
+    using namespace Simd;
+    const float* src[6] = { centerX, centerY, centerZ, extentX, extentY, extentZ };
+    float4 p[FrustumPlaneCount][4];
+    float4 a[FrustumPlaneCount][3];
+    for (int k = 0; k < FrustumPlaneCount; ++k) {
+        
+        const float* plane = &planes[k].x;
+        for (int c = 0; c < 4; ++c) {
+            p[k][c] = Splat(plane[c]);
+        }
+        for (int c = 0; c < 3; ++c) {
+            a[k][c] = Splat(std::fabs(plane[c]));
+        }
+    }
+    
+    float tail[6][4];
+    for (size_t i = 0; i < count; i += 4) {
+        
+        float4 v[6];
+        size_t used = count - i < 4 ? count - i : 4;
+        if (used == 4) {
+            
+            for (int c = 0; c < 6; ++c) {
+                v[c] = Load(src[c] + i);
+            }
+        } else {
+            
+            for (int c = 0; c < 6; ++c) {
+                
+                for (size_t j = 0; j < 4; ++j) {
+                    tail[c][j] = j < used ? src[c][i + j] : 0;
+                }
+                v[c] = Load(tail[c]);
+            }
+        }
+        
+        float4 nearest = Splat(1);
+        for (int k = 0; k < FrustumPlaneCount; ++k) {
+            
+            float4 d = MulAdd(v[0], p[k][0], p[k][3]);
+            d = MulAdd(v[1], p[k][1], d);
+            d = MulAdd(v[2], p[k][2], d);
+            d = MulAdd(v[3], a[k][0], d);
+            d = MulAdd(v[4], a[k][1], d);
+            d = MulAdd(v[5], a[k][2], d);
+            nearest = Min(nearest, d);
+        }
+        
+        uint32_t bits = ~SignMask(nearest) & ((1u << used) - 1);
+        if (i % 32 == 0)
+            visible[i / 32] = 0;
+        visible[i / 32] |= bits << (i % 32);
+    }
+}
+
+inline bool IsVisible(const uint32_t* visible, size_t i) {
+    
+    return (visible[i / 32] >> (i % 32)) & 1;
+}
@@ -0,0 +1,563 @@
+//
+//  GLDispatch.hpp
+//  TouchCone
+//
+//  Created by zhangdl on 4/6/14.
+//  Copyright (c) 2014 com.*. All rights reserved.
+//
+
+#pragma once
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+// The engines' OpenGL ES, ES1 and ES2 together, as a table of function
+// pointers filled in at run time instead of calls linked against a system
+// library.  Each gl* name the engines use is a macro for the current table's
+// entry, so the engine code is the same either way; GLES1.hpp and GLES2.hpp
+// pick this or the iOS headers.  The table starts out empty: a host fills it
+// before creating an engine, with LoadNullGL() below or from a real context,
+// and may wrap it with CountGLCalls().  Only the names, types and constants
+// the engines and the headless host use are here, with the values of the
+// Khronos headers.
+
+typedef unsigned int GLenum;
+typedef unsigned char GLboolean;
+typedef unsigned int GLbitfield;
+typedef void GLvoid;
+typedef int GLint;
+typedef int GLsizei;
+typedef unsigned char GLubyte;
+typedef unsigned int GLuint;
+typedef float GLfloat;
+typedef float GLclampf;
+typedef char GLchar;
+typedef ptrdiff_t GLintptr;
+typedef ptrdiff_t GLsizeiptr;
+
+#define GL_FALSE                          0
+#define GL_TRUE                           1
+#define GL_NO_ERROR                       0
+#define GL_ONE                            1
+#define GL_TRIANGLES                      0x0004
+#define GL_DEPTH_BUFFER_BIT               0x00000100
+#define GL_COLOR_BUFFER_BIT               0x00004000
+#define GL_SRC_ALPHA                      0x0302
+#define GL_ONE_MINUS_SRC_ALPHA            0x0303
+#define GL_DEPTH_TEST                     0x0B71
+#define GL_BLEND                          0x0BE2
+#define GL_UNSIGNED_BYTE                  0x1401
+#define GL_SHORT                          0x1402
+#define GL_UNSIGNED_SHORT                 0x1403
+#define GL_INT                            0x1404
+#define GL_UNSIGNED_INT                   0x1405
+#define GL_FLOAT                          0x1406
+#define GL_MODELVIEW                      0x1700
+#define GL_PROJECTION                     0x1701
+#define GL_RGBA                           0x1908
+#define GL_RENDERER                       0x1F01
+#define GL_EXTENSIONS                     0x1F03
+#define GL_VERTEX_ARRAY                   0x8074
+#define GL_COLOR_ARRAY                    0x8076
+#define GL_DEPTH_COMPONENT16              0x81A5
+#define GL_ARRAY_BUFFER                   0x8892
+#define GL_ELEMENT_ARRAY_BUFFER           0x8893
+#define GL_STATIC_DRAW                    0x88E4
+#define GL_FRAGMENT_SHADER                0x8B30
+#define GL_VERTEX_SHADER                  0x8B31
+#define GL_FLOAT_VEC2                     0x8B50
+#define GL_FLOAT_VEC3                     0x8B51
+#define GL_FLOAT_VEC4                     0x8B52
+#define GL_INT_VEC2                       0x8B53
+#define GL_INT_VEC3                       0x8B54
+#define GL_INT_VEC4                       0x8B55
+#define GL_BOOL                           0x8B56
+#define GL_BOOL_VEC2                      0x8B57
+#define GL_BOOL_VEC3                      0x8B58
+#define GL_BOOL_VEC4                      0x8B59
+#define GL_FLOAT_MAT2                     0x8B5A
+#define GL_FLOAT_MAT3                     0x8B5B
+#define GL_FLOAT_MAT4                     0x8B5C
+#define GL_SAMPLER_2D                     0x8B5E
+#define GL_COMPILE_STATUS                 0x8B81
+#define GL_LINK_STATUS                    0x8B82
+#define GL_ACTIVE_UNIFORMS                0x8B86
+#define GL_ACTIVE_UNIFORM_MAX_LENGTH      0x8B87
+#define GL_ACTIVE_ATTRIBUTES              0x8B89
+#define GL_ACTIVE_ATTRIBUTE_MAX_LENGTH    0x8B8A
+#define GL_FRAMEBUFFER_COMPLETE           0x8CD5
+#define GL_COLOR_ATTACHMENT0              0x8CE0
+#define GL_DEPTH_ATTACHMENT               0x8D00
+#define GL_FRAMEBUFFER                    0x8D40
+#define GL_RENDERBUFFER                   0x8D41
+#define GL_HALF_FLOAT_OES                 0x8D61
+#define GL_RGB565                         0x8D62
+
+#define GL_DEPTH_COMPONENT16_OES          GL_DEPTH_COMPONENT16
+#define GL_FRAMEBUFFER_COMPLETE_OES       GL_FRAMEBUFFER_COMPLETE
+#define GL_COLOR_ATTACHMENT0_OES          GL_COLOR_ATTACHMENT0
+#define GL_DEPTH_ATTACHMENT_OES           GL_DEPTH_ATTACHMENT
+#define GL_FRAMEBUFFER_OES                GL_FRAMEBUFFER
+#define GL_RENDERBUFFER_OES               GL_RENDERBUFFER
+#define GL_RGB565_OES                     GL_RGB565
+
+// Every entry as F(return type, name without "gl", parameter list).  ES1 and
+// ES2 share the functions both have; a context of one version leaves the
+// other's entries as they were.
+#define GL_DISPATCH_FUNCTIONS(F) \
+    F(void, AttachShader, (GLuint program, GLuint shader)) \
+    F(void, BindBuffer, (GLenum target, GLuint buffer)) \
+    F(void, BindFramebuffer, (GLenum target, GLuint framebuffer)) \
+    F(void, BindRenderbuffer, (GLenum target, GLuint renderbuffer)) \
+    F(void, BlendFunc, (GLenum source, GLenum destination)) \
+    F(void, BufferData, (GLenum target, GLsizeiptr size, const GLvoid* data, GLenum usage)) \
+    F(void, BufferSubData, (GLenum target, GLintptr offset, GLsizeiptr size, const GLvoid* data)) \
+    F(GLenum, CheckFramebufferStatus, (GLenum target)) \
+    F(void, Clear, (GLbitfield mask)) \
+    F(void, ClearColor, (GLclampf red, GLclampf green, GLclampf blue, GLclampf alpha)) \
+    F(void, CompileShader, (GLuint shader)) \
+    F(GLuint, CreateProgram, ()) \
+    F(GLuint, CreateShader, (GLenum type)) \
+    F(void, DeleteBuffers, (GLsizei n, const GLuint* buffers)) \
+    F(void, DeleteProgram, (GLuint program)) \
+    F(void, DepthMask, (GLboolean flag)) \
+    F(void, Disable, (GLenum capability)) \
+    F(void, DisableVertexAttribArray, (GLuint index)) \
+    F(void, DrawElements, (GLenum mode, GLsizei count, GLenum type, const GLvoid* indices)) \
+    F(void, Enable, (GLenum capability)) \
+    F(void, EnableVertexAttribArray, (GLuint index)) \
+    F(void, Finish, ()) \
+    F(void, FramebufferRenderbuffer, (GLenum target, GLenum attachment, GLenum renderbufferTarget, \
+                                      GLuint renderbuffer)) \
+    F(void, GenBuffers, (GLsizei n, GLuint* buffers)) \
+    F(void, GenFramebuffers, (GLsizei n, GLuint* framebuffers)) \
+    F(void, GenRenderbuffers, (GLsizei n, GLuint* renderbuffers)) \
+    F(void, GetActiveAttrib, (GLuint program, GLuint index, GLsizei bufferSize, GLsizei* length, \
+                              GLint* size, GLenum* type, GLchar* name)) \
+    F(void, GetActiveUniform, (GLuint program, GLuint index, GLsizei bufferSize, GLsizei* length, \
+                               GLint* size, GLenum* type, GLchar* name)) \
+    F(GLint, GetAttribLocation, (GLuint program, const GLchar* name)) \
+    F(GLenum, GetError, ()) \
+    F(void, GetProgramInfoLog, (GLuint program, GLsizei bufferSize, GLsizei* length, GLchar* log)) \
+    F(void, GetProgramiv, (GLuint program, GLenum name, GLint* value)) \
+    F(void, GetShaderInfoLog, (GLuint shader, GLsizei bufferSize, GLsizei* length, GLchar* log)) \
+    F(void, GetShaderiv, (GLuint shader, GLenum name, GLint* value)) \
+    F(const GLubyte*, GetString, (GLenum name)) \
+    F(GLint, GetUniformLocation, (GLuint program, const GLchar* name)) \
+    F(void, LinkProgram, (GLuint program)) \
+    F(void, ReadPixels, (GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, \
+                         GLvoid* pixels)) \
+    F(void, RenderbufferStorage, (GLenum target, GLenum format, GLsizei width, GLsizei height)) \
+    F(void, ShaderSource, (GLuint shader, GLsizei count, const GLchar* const* sources, const GLint* lengths)) \
+    F(void, Uniform1fv, (GLint location, GLsizei count, const GLfloat* values)) \
+    F(void, Uniform2fv, (GLint location, GLsizei count, const GLfloat* values)) \
+    F(void, Uniform3fv, (GLint location, GLsizei count, const GLfloat* values)) \
+    F(void, Uniform4fv, (GLint location, GLsizei count, const GLfloat* values)) \
+    F(void, Uniform1iv, (GLint location, GLsizei count, const GLint* values)) \
+    F(void, Uniform2iv, (GLint location, GLsizei count, const GLint* values)) \
+    F(void, Uniform3iv, (GLint location, GLsizei count, const GLint* values)) \
+    F(void, Uniform4iv, (GLint location, GLsizei count, const GLint* values)) \
+    F(void, UniformMatrix2fv, (GLint location, GLsizei count, GLboolean transpose, const GLfloat* values)) \
+    F(void, UniformMatrix3fv, (GLint location, GLsizei count, GLboolean transpose, const GLfloat* values)) \
+    F(void, UniformMatrix4fv, (GLint location, GLsizei count, GLboolean transpose, const GLfloat* values)) \
+    F(void, UseProgram, (GLuint program)) \
+    F(void, VertexAttrib4fv, (GLuint index, const GLfloat* values)) \
+    F(void, VertexAttribPointer, (GLuint index, GLint size, GLenum type, GLboolean normalized, \
+                                  GLsizei stride, const GLvoid* pointer)) \
+    F(void, Viewport, (GLint x, GLint y, GLsizei width, GLsizei height)) \
+    F(void, BindFramebufferOES, (GLenum target, GLuint framebuffer)) \
+    F(void, BindRenderbufferOES, (GLenum target, GLuint renderbuffer)) \
+    F(GLenum, CheckFramebufferStatusOES, (GLenum target)) \
+    F(void, FramebufferRenderbufferOES, (GLenum target, GLenum attachment, GLenum renderbufferTarget, \
+                                         GLuint renderbuffer)) \
+    F(void, GenFramebuffersOES, (GLsizei n, GLuint* framebuffers)) \
+    F(void, GenRenderbuffersOES, (GLsizei n, GLuint* renderbuffers)) \
+    F(void, RenderbufferStorageOES, (GLenum target, GLenum format, GLsizei width, GLsizei height)) \
+    F(void, Color4f, (GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha)) \
+    F(void, ColorPointer, (GLint size, GLenum type, GLsizei stride, const GLvoid* pointer)) \
+    F(void, DisableClientState, (GLenum array)) \
+    F(void, EnableClientState, (GLenum array)) \
+    F(void, Frustumf, (GLfloat left, GLfloat right, GLfloat bottom, GLfloat top, GLfloat zNear, GLfloat zFar)) \
+    F(void, MatrixMode, (GLenum mode)) \
+    F(void, PopMatrix, ()) \
+    F(void, PushMatrix, ()) \
+    F(void, Rotatef, (GLfloat angle, GLfloat x, GLfloat y, GLfloat z)) \
+    F(void, Scalef, (GLfloat x, GLfloat y, GLfloat z)) \
+    F(void, Translatef, (GLfloat x, GLfloat y, GLfloat z)) \
+    F(void, VertexPointer, (GLint size, GLenum type, GLsizei stride, const GLvoid* pointer))
+
+#define GL_DISPATCH_ENTRY(R, name, parameters) R (*name) parameters;
+#define GL_DISPATCH_INDEX(R, name, parameters) GLFunction##name,
+#define GL_DISPATCH_NAME(R, name, parameters) "gl" #name,
+
+struct GLDispatch {
+    GL_DISPATCH_FUNCTIONS(GL_DISPATCH_ENTRY)
+};
+
+enum GLFunction {
+    GL_DISPATCH_FUNCTIONS(GL_DISPATCH_INDEX)
+    GLFunctionCount
+};
+
+// "glDrawElements" and so on, by GLFunction.
+inline const char* GetGLFunctionName(int function) {
+    
+    static const char* const names[] = { GL_DISPATCH_FUNCTIONS(GL_DISPATCH_NAME) };
+    return names[function];
+}
+
+// The table every gl* call goes through.  It's plain data, so it's zeroed
+// before anything runs and reading it costs no initialization check.
+inline GLDispatch& GetGLDispatch() {
+    
+    static GLDispatch dispatch;
+    return dispatch;
+}
+
+#define glAttachShader GetGLDispatch().AttachShader
+#define glBindBuffer GetGLDispatch().BindBuffer
+#define glBindFramebuffer GetGLDispatch().BindFramebuffer
+#define glBindRenderbuffer GetGLDispatch().BindRenderbuffer
+#define glBlendFunc GetGLDispatch().BlendFunc
+#define glBufferData GetGLDispatch().BufferData
+#define glBufferSubData GetGLDispatch().BufferSubData
+#define glCheckFramebufferStatus GetGLDispatch().CheckFramebufferStatus
+#define glClear GetGLDispatch().Clear
+#define glClearColor GetGLDispatch().ClearColor
+#define glCompileShader GetGLDispatch().CompileShader
+#define glCreateProgram GetGLDispatch().CreateProgram
+#define glCreateShader GetGLDispatch().CreateShader
+#define glDeleteBuffers GetGLDispatch().DeleteBuffers
+#define glDeleteProgram GetGLDispatch().DeleteProgram
+#define glDepthMask GetGLDispatch().DepthMask
+#define glDisable GetGLDispatch().Disable
+#define glDisableVertexAttribArray GetGLDispatch().DisableVertexAttribArray
+#define glDrawElements GetGLDispatch().DrawElements
+#define glEnable GetGLDispatch().Enable
+#define glEnableVertexAttribArray GetGLDispatch().EnableVertexAttribArray
+#define glFinish GetGLDispatch().Finish
+#define glFramebufferRenderbuffer GetGLDispatch().FramebufferRenderbuffer
+#define glGenBuffers GetGLDispatch().GenBuffers
+#define glGenFramebuffers GetGLDispatch().GenFramebuffers
+#define glGenRenderbuffers GetGLDispatch().GenRenderbuffers
+#define glGetActiveAttrib GetGLDispatch().GetActiveAttrib
+#define glGetActiveUniform GetGLDispatch().GetActiveUniform
+#define glGetAttribLocation GetGLDispatch().GetAttribLocation
+#define glGetError GetGLDispatch().GetError
+#define glGetProgramInfoLog GetGLDispatch().GetProgramInfoLog
+#define glGetProgramiv GetGLDispatch().GetProgramiv
+#define glGetShaderInfoLog GetGLDispatch().GetShaderInfoLog
+#define glGetShaderiv GetGLDispatch().GetShaderiv
+#define glGetString GetGLDispatch().GetString
+#define glGetUniformLocation GetGLDispatch().GetUniformLocation
+#define glLinkProgram GetGLDispatch().LinkProgram
+#define glReadPixels GetGLDispatch().ReadPixels
+#define glRenderbufferStorage GetGLDispatch().RenderbufferStorage
+#define glShaderSource GetGLDispatch().ShaderSource
+#define glUniform1fv GetGLDispatch().Uniform1fv
+#define glUniform2fv GetGLDispatch().Uniform2fv
+#define glUniform3fv GetGLDispatch().Uniform3fv
+#define glUniform4fv GetGLDispatch().Uniform4fv
+#define glUniform1iv GetGLDispatch().Uniform1iv
+#define glUniform2iv GetGLDispatch().Uniform2iv
+#define glUniform3iv GetGLDispatch().Uniform3iv
+#define glUniform4iv GetGLDispatch().Uniform4iv
+#define glUniformMatrix2fv GetGLDispatch().UniformMatrix2fv
+#define glUniformMatrix3fv GetGLDispatch().UniformMatrix3fv
+#define glUniformMatrix4fv GetGLDispatch().UniformMatrix4fv
+#define glUseProgram GetGLDispatch().UseProgram
+#define glVertexAttrib4fv GetGLDispatch().VertexAttrib4fv
+#define glVertexAttribPointer GetGLDispatch().VertexAttribPointer
+#define glViewport GetGLDispatch().Viewport
+#define glBindFramebufferOES GetGLDispatch().BindFramebufferOES
+#define glBindRenderbufferOES GetGLDispatch().BindRenderbufferOES
+#define glCheckFramebufferStatusOES GetGLDispatch().CheckFramebufferStatusOES
+#define glFramebufferRenderbufferOES GetGLDispatch().FramebufferRenderbufferOES
+#define glGenFramebuffersOES GetGLDispatch().GenFramebuffersOES
+#define glGenRenderbuffersOES GetGLDispatch().GenRenderbuffersOES
+#define glRenderbufferStorageOES GetGLDispatch().RenderbufferStorageOES
+#define glColor4f GetGLDispatch().Color4f
+#define glColorPointer GetGLDispatch().ColorPointer
+#define glDisableClientState GetGLDispatch().DisableClientState
+#define glEnableClientState GetGLDispatch().EnableClientState
+#define glFrustumf GetGLDispatch().Frustumf
+#define glMatrixMode GetGLDispatch().MatrixMode
+#define glPopMatrix GetGLDispatch().PopMatrix
+#define glPushMatrix GetGLDispatch().PushMatrix
+#define glRotatef GetGLDispatch().Rotatef
+#define glScalef GetGLDispatch().Scalef
+#define glTranslatef GetGLDispatch().Translatef
+#define glVertexPointer GetGLDispatch().VertexPointer
+
+// Stand-ins for one signature.  Ignore does nothing and returns zero; Count
+// adds to the function's count and calls the entry of the table it wraps.
+template <typename Function> struct GLThunk;
+template <typename R, typename... Parameters> struct GLThunk<R (*)(Parameters...)> {
+    
+    typedef R (*Pointer)(Parameters...);
+    static R Ignore(Parameters...) { return R(); }
+    template <Pointer GLDispatch::*Entry, int Function> static R Count(Parameters... arguments);
+};
+
+// Calls per GLFunction since the last reset, and the table the counting
+// entries forward to.
+struct GLCallCounts {
+    
+    unsigned calls[GLFunctionCount];
+    GLDispatch counted;
+};
+
+inline GLCallCounts& GetGLCallCounts() {
+    
+    static GLCallCounts counts;
+    return counts;
+}
+
+template <typename R, typename... Parameters>
+template <R (*GLDispatch::*Entry)(Parameters...), int Function>
+inline R GLThunk<R (*)(Parameters...)>::Count(Parameters... arguments) {
+    
+    GLCallCounts& counts = GetGLCallCounts();
+    ++counts.calls[Function];
+    return (counts.counted.*Entry)(arguments...);
+}
+
+// Wraps every entry of the current table so each call is counted before it
+// goes through.  Wrap once; counts are read and reset through
+// GetGLCallCounts().calls.
+inline void CountGLCalls() {
+    
+    GLDispatch& dispatch = GetGLDispatch();
+    GLCallCounts& counts = GetGLCallCounts();
+    counts.counted = dispatch;
+    std::memset(counts.calls, 0, sizeof(counts.calls));
+    #define GL_DISPATCH_COUNT(R, name, parameters) \
+        dispatch.name = &GLThunk<decltype(dispatch.name)>::Count<&GLDispatch::name, GLFunction##name>;
+    GL_DISPATCH_FUNCTIONS(GL_DISPATCH_COUNT)
+    #undef GL_DISPATCH_COUNT
+}
+
+// The no-op backend: no context and no drawing, so the cost left is the
+// engine's own.  Calls return zero except for what the engines rely on:
+// names from the Gen and Create calls, shaders and programs that compile
+// and link, and an extension string that has what iOS devices have.  A
+// linked program reports the attributes and uniforms its shaders' source
+// declares, at locations 0, 1, ... in declaration order, so the engines
+// reflect it and set up their draws as they would with a real driver.
+// Replaces every entry.
+inline void LoadNullGL() {
+    
+    struct Null {
+        
+        struct Variable {
+            
+            GLenum type;
+            GLint size;
+            std::string name;   // as glGetActive* reports it, with [0] on an array
+        };
+        struct Object {
+            
+            std::string source;
+            std::vector<GLuint> shaders;
+            std::vector<Variable> attributes;
+            std::vector<Variable> uniforms;
+        };
+        
+        static GLuint NextName() {
+            
+            static GLuint name = 0;
+            return ++name;
+        }
+        // Shaders and programs by name; they share one sequence of names.
+        static Object& GetObject(GLuint name) {
+            
+            static std::map<GLuint, Object> objects;
+            return objects[name];
+        }
+        static void Generate(GLsizei n, GLuint* names) {
+            
+            for (GLsizei i = 0; i < n; ++i) {
+                names[i] = NextName();
+            }
+        }
+        static GLuint Create() { return NextName(); }
+        static GLuint CreateShader(GLenum) { return NextName(); }
+        static void ShaderSource(GLuint shader, GLsizei count, const GLchar* const* sources, const GLint* lengths) {
+            
+            std::string& source = GetObject(shader).source;
+            source.clear();
+            for (GLsizei i = 0; i < count; ++i) {
+                source.append(sources[i], lengths && lengths[i] >= 0 ? lengths[i] : std::strlen(sources[i]));
+            }
+        }
+        static void AttachShader(GLuint program, GLuint shader) { GetObject(program).shaders.push_back(shader); }
+        static GLenum GetType(const std::string& type) {
+            
+            const char* const names[] = {
+                "float", "vec2", "vec3", "vec4", "mat2", "mat3", "mat4",
+                "int", "ivec2", "ivec3", "ivec4", "bool", "bvec2", "bvec3", "bvec4", "sampler2D",
+            };
+            const GLenum types[] = {
+                GL_FLOAT, GL_FLOAT_VEC2, GL_FLOAT_VEC3, GL_FLOAT_VEC4, GL_FLOAT_MAT2, GL_FLOAT_MAT3, GL_FLOAT_MAT4,
+                GL_INT, GL_INT_VEC2, GL_INT_VEC3, GL_INT_VEC4, GL_BOOL, GL_BOOL_VEC2, GL_BOOL_VEC3, GL_BOOL_VEC4,
+                GL_SAMPLER_2D,
+            };
+            for (size_t i = 0; i < sizeof(types) / sizeof(types[0]); ++i) {
+                
+                if (type == names[i])
+                    return types[i];
+            }
+            return 0;
+        }
+        // Finds each "attribute" or "uniform" declaration: the keyword, an
+        // optional precision, a type and a name.  Adds the ones not declared
+        // already, say by the other shader, to attributes or uniforms.
+        static void Declare(const std::string& source, std::vector<Variable>& attributes,
+                            std::vector<Variable>& uniforms) {
+            
+            std::vector<std::string> words(1);
+            for (size_t i = 0; i < source.size(); ++i) {
+                
+                char c = source[i];
+                if (std::isalnum((unsigned char) c) || c == '_' || c == '[' || c == ']')
+                    words.back() += c;
+                else if (!words.back().empty())
+                    words.push_back(std::string());
+            }
+            for (size_t i = 0; i + 2 < words.size(); ++i) {
+                
+                if (words[i] != "attribute" && words[i] != "uniform")
+                    continue;
+                size_t t = i + 1;
+                if (words[t] == "lowp" || words[t] == "mediump" || words[t] == "highp")
+                    ++t;
+                if (t + 1 >= words.size() || !GetType(words[t]))
+                    continue;
+                
+                Variable variable = { GetType(words[t]), 1, words[t + 1] };
+                size_t bracket = variable.name.find('[');
+                if (bracket != std::string::npos) {
+                    
+                    variable.size = std::atoi(variable.name.c_str() + bracket + 1);
+                    variable.name.replace(bracket, std::string::npos, "[0]");
+                }
+                std::vector<Variable>& declared = words[i] == "attribute" ? attributes : uniforms;
+                bool known = false;
+                for (size_t v = 0; v < declared.size(); ++v) {
+                    known = known || declared[v].name == variable.name;
+                }
+                if (!known)
+                    declared.push_back(variable);
+            }
+        }
+        static void LinkProgram(GLuint program) {
+            
+            std::vector<Variable> attributes, uniforms;
+            std::vector<GLuint> shaders = GetObject(program).shaders;
+            for (size_t i = 0; i < shaders.size(); ++i) {
+                Declare(GetObject(shaders[i]).source, attributes, uniforms);
+            }
+            GetObject(program).attributes.swap(attributes);
+            GetObject(program).uniforms.swap(uniforms);
+        }
+        static GLenum CheckFramebufferStatus(GLenum) { return GL_FRAMEBUFFER_COMPLETE; }
+        static void GetParameter(GLuint object, GLenum name, GLint* value) {
+            
+            const Object& o = GetObject(object);
+            const std::vector<Variable>& variables =
+                name == GL_ACTIVE_ATTRIBUTES || name == GL_ACTIVE_ATTRIBUTE_MAX_LENGTH ? o.attributes : o.uniforms;
+            size_t longest = 0;
+            for (size_t i = 0; i < variables.size(); ++i) {
+                longest = variables[i].name.size() > longest ? variables[i].name.size() : longest;
+            }
+            switch (name) {
+                case GL_COMPILE_STATUS: case GL_LINK_STATUS: *value = GL_TRUE; break;
+                case GL_ACTIVE_ATTRIBUTES: case GL_ACTIVE_UNIFORMS: *value = (GLint) variables.size(); break;
+                case GL_ACTIVE_ATTRIBUTE_MAX_LENGTH: case GL_ACTIVE_UNIFORM_MAX_LENGTH: *value = (GLint) longest + 1; break;
+                default: *value = 0; break;
+            }
+        }
+        static void GetActive(const std::vector<Variable>& variables, GLuint index, GLsizei bufferSize,
+                              GLsizei* length, GLint* size, GLenum* type, GLchar* name) {
+            
+            const Variable* variable = index < variables.size() ? &variables[index] : 0;
+            GLsizei copied = variable && bufferSize > 0 ? std::min((GLsizei) variable->name.size(), bufferSize - 1) : 0;
+            if (bufferSize > 0) {
+                
+                std::memcpy(name, variable ? variable->name.c_str() : "", copied);
+                name[copied] = 0;
+            }
+            if (length)
+                *length = copied;
+            *size = variable ? variable->size : 0;
+            *type = variable ? variable->type : 0;
+        }
+        static void GetActiveAttrib(GLuint program, GLuint index, GLsizei bufferSize, GLsizei* length,
+                                    GLint* size, GLenum* type, GLchar* name) {
+            
+            GetActive(GetObject(program).attributes, index, bufferSize, length, size, type, name);
+        }
+        static void GetActiveUniform(GLuint program, GLuint index, GLsizei bufferSize, GLsizei* length,
+                                     GLint* size, GLenum* type, GLchar* name) {
+            
+            GetActive(GetObject(program).uniforms, index, bufferSize, length, size, type, name);
+        }
+        // A variable's location is its index; an array answers to its name
+        // with or without [0].
+        static GLint GetLocation(const std::vector<Variable>& variables, const GLchar* name) {
+            
+            for (size_t i = 0; i < variables.size(); ++i) {
+                
+                if (variables[i].name == name || variables[i].name == std::string(name) + "[0]")
+                    return (GLint) i;
+            }
+            return -1;
+        }
+        static GLint GetAttribLocation(GLuint program, const GLchar* name) {
+            
+            return GetLocation(GetObject(program).attributes, name);
+        }
+        static GLint GetUniformLocation(GLuint program, const GLchar* name) {
+            
+            return GetLocation(GetObject(program).uniforms, name);
+        }
+        static void GetInfoLog(GLuint, GLsizei bufferSize, GLsizei* length, GLchar* log) {
+            
+            if (length)
+                *length = 0;
+            if (bufferSize > 0)
+                *log = 0;
+        }
+        static const GLubyte* GetString(GLenum name) {
+            
+            static const char* const extensions = "GL_OES_element_index_uint GL_OES_vertex_half_float";
+            return (const GLubyte*) (name == GL_EXTENSIONS ? extensions : "Null");
+        }
+    };
+    
+    GLDispatch& dispatch = GetGLDispatch();
+    #define GL_DISPATCH_IGNORE(R, name, parameters) dispatch.name = &GLThunk<decltype(dispatch.name)>::Ignore;
+    GL_DISPATCH_FUNCTIONS(GL_DISPATCH_IGNORE)
+    #undef GL_DISPATCH_IGNORE
+    
+    dispatch.GenBuffers = dispatch.GenFramebuffers = dispatch.GenRenderbuffers = &Null::Generate;
+    dispatch.GenFramebuffersOES = dispatch.GenRenderbuffersOES = &Null::Generate;
+    dispatch.CreateProgram = &Null::Create;
+    dispatch.CreateShader = &Null::CreateShader;
+    dispatch.ShaderSource = &Null::ShaderSource;
+    dispatch.AttachShader = &Null::AttachShader;
+    dispatch.LinkProgram = &Null::LinkProgram;
+    dispatch.CheckFramebufferStatus = dispatch.CheckFramebufferStatusOES = &Null::CheckFramebufferStatus;
+    dispatch.GetProgramiv = dispatch.GetShaderiv = &Null::GetParameter;
+    dispatch.GetProgramInfoLog = dispatch.GetShaderInfoLog = &Null::GetInfoLog;
+    dispatch.GetActiveAttrib = &Null::GetActiveAttrib;
+    dispatch.GetActiveUniform = &Null::GetActiveUniform;
+    dispatch.GetAttribLocation = &Null::GetAttribLocation;
+    dispatch.GetUniformLocation = &Null::GetUniformLocation;
+    dispatch.GetString = &Null::GetString;
+}
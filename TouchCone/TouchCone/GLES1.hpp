@@ -0,0 +1,19 @@
+//
+//  GLES1.hpp
+//  TouchCone
+//
+//  Created by zhangdl on 4/6/14.
+//  Copyright (c) 2014 com.*. All rights reserved.
+//
+
+#pragma once
+
+// OpenGL ES 1.0 as the engines see it: the system headers on iOS, or calls
+// through the run-time table of GLDispatch.hpp where there are none, and
+// anywhere GLDISPATCH is defined.
+#if defined(__APPLE__) && !defined(GLDISPATCH)
+#include <OpenGLES/ES1/gl.h>
+#include <OpenGLES/ES1/glext.h>
+#else
+#include "GLDispatch.hpp"
+#endif
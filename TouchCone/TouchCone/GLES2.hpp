@@ -0,0 +1,19 @@
+//
+//  GLES2.hpp
+//  TouchCone
+//
+//  Created by zhangdl on 4/6/14.
+//  Copyright (c) 2014 com.*. All rights reserved.
+//
+
+#pragma once
+
+// OpenGL ES 2.0 as the engines see it: the system headers on iOS, or calls
+// through the run-time table of GLDispatch.hpp where there are none, and
+// anywhere GLDISPATCH is defined.
+#if defined(__APPLE__) && !defined(GLDISPATCH)
+#include <OpenGLES/ES2/gl.h>
+#include <OpenGLES/ES2/glext.h>
+#else
+#include "GLDispatch.hpp"
+#endif
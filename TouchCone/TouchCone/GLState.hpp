@@ -0,0 +1,273 @@
+//
+//  GLState.hpp
+//  TouchCone
+//
+//  Created by zhangdl on 2/6/14.
+//  Copyright (c) 2014 com.*. All rights reserved.
+//
+
+#pragma once
+#include <cstddef>
+#include <vector>
+#include "GLES2.hpp"
+
+// A shadow of the GL state the ES2 engine changes while drawing.  Each call
+// is compared against what was last set and only reaches the driver when it
+// would change something.  The shadow starts out, and is reset by
+// Invalidate(), as unknown, so the first call of every kind always goes
+// through; after that it's only right if all of these changes go through
+// here.
+class GLState {
+
+public:
+    static const GLuint MaxAttributes = 16;
+    
+    GLState() : m_callCount(0), m_filteredCount(0), m_frameCallCount(0), m_frameFilteredCount(0) { Invalidate(); }
+    void Invalidate();
+    
+    void UseProgram(GLuint program);
+    void BindBuffer(GLenum target, GLuint buffer);
+    void DeleteBuffer(GLuint buffer);
+    void EnableVertexAttribArray(GLuint index) { SetVertexAttribArray(index, true); }
+    void DisableVertexAttribArray(GLuint index) { SetVertexAttribArray(index, false); }
+    void VertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized,
+                             GLsizei stride, const GLvoid* pointer);
+    void Enable(GLenum capability) { SetCapability(capability, true); }
+    void Disable(GLenum capability) { SetCapability(capability, false); }
+    void DepthMask(GLboolean enabled);
+    void BlendFunc(GLenum source, GLenum destination);
+    void ClearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha);
+    void Viewport(GLint x, GLint y, GLsizei width, GLsizei height);
+    
+    // Closes the frame's counts, which GetFrameCallCount() and
+    // GetFrameFilteredCount() report until the next EndFrame().
+    void EndFrame();
+    
+    // Calls made during the last finished frame, and how many of them were
+    // redundant and never reached GL.
+    unsigned GetFrameCallCount() const { return m_frameCallCount; }
+    unsigned GetFrameFilteredCount() const { return m_frameFilteredCount; }
+
+private:
+    GLState(const GLState&);
+    GLState& operator = (const GLState&);
+    
+    struct Attribute {
+        
+        bool enabledKnown;
+        bool enabled;
+        bool pointerKnown;
+        GLint size;
+        GLenum type;
+        GLboolean normalized;
+        GLsizei stride;
+        const GLvoid* pointer;
+        GLuint buffer;
+    };
+    struct Capability {
+        
+        GLenum name;
+        bool enabled;
+    };
+    
+    // Counts the call and returns redundant.
+    bool Filter(bool redundant);
+    void SetVertexAttribArray(GLuint index, bool enabled);
+    void SetCapability(GLenum capability, bool enabled);
+    
+    bool m_programKnown;
+    GLuint m_program;
+    bool m_arrayBufferKnown;
+    GLuint m_arrayBuffer;
+    bool m_elementBufferKnown;
+    GLuint m_elementBuffer;
+    Attribute m_attributes[MaxAttributes];
+    std::vector<Capability> m_capabilities;
+    bool m_depthMaskKnown;
+    GLboolean m_depthMask;
+    bool m_blendFuncKnown;
+    GLenum m_blendFunc[2];
+    bool m_clearColorKnown;
+    GLfloat m_clearColor[4];
+    bool m_viewportKnown;
+    GLint m_viewport[4];
+    
+    unsigned m_callCount;
+    unsigned m_filteredCount;
+    unsigned m_frameCallCount;
+    unsigned m_frameFilteredCount;
+};
+
+inline void GLState::Invalidate() {
+    
+    m_programKnown = false;
+    m_arrayBufferKnown = false;
+    m_elementBufferKnown = false;
+    for (GLuint i = 0; i < MaxAttributes; ++i) {
+        
+        m_attributes[i].enabledKnown = false;
+        m_attributes[i].pointerKnown = false;
+    }
+    m_capabilities.clear();
+    m_depthMaskKnown = false;
+    m_blendFuncKnown = false;
+    m_clearColorKnown = false;
+    m_viewportKnown = false;
+}
+
+inline bool GLState::Filter(bool redundant) {
+    
+    ++m_callCount;
+    if (redundant)
+        ++m_filteredCount;
+    return redundant;
+}
+
+inline void GLState::UseProgram(GLuint program) {
+    
+    if (Filter(m_programKnown && m_program == program))
+        return;
+    glUseProgram(program);
+    m_programKnown = true;
+    m_program = program;
+}
+
+inline void GLState::BindBuffer(GLenum target, GLuint buffer) {
+    
+    bool& known = target == GL_ARRAY_BUFFER ? m_arrayBufferKnown : m_elementBufferKnown;
+    GLuint& bound = target == GL_ARRAY_BUFFER ? m_arrayBuffer : m_elementBuffer;
+    if (Filter(known && bound == buffer))
+        return;
+    glBindBuffer(target, buffer);
+    known = true;
+    bound = buffer;
+}
+
+// Deleting a bound buffer binds 0 in its place.  Attribute pointers into it
+// are left dangling, so they're forgotten too.
+inline void GLState::DeleteBuffer(GLuint buffer) {
+    
+    glDeleteBuffers(1, &buffer);
+    if (m_arrayBufferKnown && m_arrayBuffer == buffer)
+        m_arrayBuffer = 0;
+    if (m_elementBufferKnown && m_elementBuffer == buffer)
+        m_elementBuffer = 0;
+    for (GLuint i = 0; i < MaxAttributes; ++i) {
+        
+        if (m_attributes[i].pointerKnown && m_attributes[i].buffer == buffer)
+            m_attributes[i].pointerKnown = false;
+    }
+}
+
+inline void GLState::SetVertexAttribArray(GLuint index, bool enabled) {
+    
+    Attribute* attribute = index < MaxAttributes ? &m_attributes[index] : 0;
+    if (Filter(attribute && attribute->enabledKnown && attribute->enabled == enabled))
+        return;
+    if (enabled)
+        glEnableVertexAttribArray(index);
+    else
+        glDisableVertexAttribArray(index);
+    if (attribute) {
+        
+        attribute->enabledKnown = true;
+        attribute->enabled = enabled;
+    }
+}
+
+// A pointer is an offset into whichever buffer is bound when it's set, so
+// that buffer is part of what's compared.
+inline void GLState::VertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized,
+                                         GLsizei stride, const GLvoid* pointer) {
+    
+    Attribute* attribute = index < MaxAttributes ? &m_attributes[index] : 0;
+    GLuint buffer = m_arrayBufferKnown ? m_arrayBuffer : 0;
+    if (Filter(attribute && attribute->pointerKnown && m_arrayBufferKnown && attribute->buffer == buffer &&
+               attribute->size == size && attribute->type == type && attribute->normalized == normalized &&
+               attribute->stride == stride && attribute->pointer == pointer))
+        return;
+    glVertexAttribPointer(index, size, type, normalized, stride, pointer);
+    if (attribute) {
+        
+        Attribute& a = *attribute;
+        a.pointerKnown = m_arrayBufferKnown;
+        a.size = size;
+        a.type = type;
+        a.normalized = normalized;
+        a.stride = stride;
+        a.pointer = pointer;
+        a.buffer = buffer;
+    }
+}
+
+inline void GLState::SetCapability(GLenum capability, bool enabled) {
+    
+    size_t i = 0;
+    while (i < m_capabilities.size() && m_capabilities[i].name != capability)
+        ++i;
+    if (Filter(i < m_capabilities.size() && m_capabilities[i].enabled == enabled))
+        return;
+    if (enabled)
+        glEnable(capability);
+    else
+        glDisable(capability);
+    if (i == m_capabilities.size()) {
+        
+        Capability c = { capability, enabled };
+        m_capabilities.push_back(c);
+    }
+    m_capabilities[i].enabled = enabled;
+}
+
+inline void GLState::DepthMask(GLboolean enabled) {
+    
+    if (Filter(m_depthMaskKnown && m_depthMask == enabled))
+        return;
+    glDepthMask(enabled);
+    m_depthMaskKnown = true;
+    m_depthMask = enabled;
+}
+
+inline void GLState::BlendFunc(GLenum source, GLenum destination) {
+    
+    if (Filter(m_blendFuncKnown && m_blendFunc[0] == source && m_blendFunc[1] == destination))
+        return;
+    glBlendFunc(source, destination);
+    m_blendFuncKnown = true;
+    m_blendFunc[0] = source;
+    m_blendFunc[1] = destination;
+}
+
+inline void GLState::ClearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha) {
+    
+    GLfloat* c = m_clearColor;
+    if (Filter(m_clearColorKnown && c[0] == red && c[1] == green && c[2] == blue && c[3] == alpha))
+        return;
+    glClearColor(red, green, blue, alpha);
+    m_clearColorKnown = true;
+    c[0] = red;
+    c[1] = green;
+    c[2] = blue;
+    c[3] = alpha;
+}
+
+inline void GLState::Viewport(GLint x, GLint y, GLsizei width, GLsizei height) {
+    
+    GLint* v = m_viewport;
+    if (Filter(m_viewportKnown && v[0] == x && v[1] == y && v[2] == width && v[3] == height))
+        return;
+    glViewport(x, y, width, height);
+    m_viewportKnown = true;
+    v[0] = x;
+    v[1] = y;
+    v[2] = width;
+    v[3] = height;
+}
+
+inline void GLState::EndFrame() {
+    
+    m_frameCallCount = m_callCount;
+    m_frameFilteredCount = m_filteredCount;
+    m_callCount = 0;
+    m_filteredCount = 0;
+}
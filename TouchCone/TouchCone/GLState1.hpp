@@ -0,0 +1,149 @@
+//
+//  GLState1.hpp
+//  TouchCone
+//
+//  Created by zhangdl on 6/6/14.
+//  Copyright (c) 2014 com.*. All rights reserved.
+//
+
+#pragma once
+#include <cstddef>
+#include <vector>
+#include "GLES1.hpp"
+
+// GLState for the ES1 engine's fixed-function calls: client array enables,
+// the vertex and color pointers and the clear color.  It works the same way,
+// starting out unknown and filtering a call that wouldn't change anything,
+// and counts calls per frame the same way.  The current color isn't here:
+// drawing with the color array enabled leaves it undefined.
+class GLState1 {
+
+public:
+    GLState1() : m_callCount(0), m_filteredCount(0), m_frameCallCount(0), m_frameFilteredCount(0) { Invalidate(); }
+    void Invalidate();
+    
+    void EnableClientState(GLenum array) { SetClientState(array, true); }
+    void DisableClientState(GLenum array) { SetClientState(array, false); }
+    void VertexPointer(GLint size, GLenum type, GLsizei stride, const GLvoid* pointer);
+    void ColorPointer(GLint size, GLenum type, GLsizei stride, const GLvoid* pointer);
+    void ClearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha);
+    
+    // As GLState's.
+    void EndFrame();
+    unsigned GetFrameCallCount() const { return m_frameCallCount; }
+    unsigned GetFrameFilteredCount() const { return m_frameFilteredCount; }
+
+private:
+    GLState1(const GLState1&);
+    GLState1& operator = (const GLState1&);
+    
+    struct Pointer {
+        
+        bool known;
+        GLint size;
+        GLenum type;
+        GLsizei stride;
+        const GLvoid* pointer;
+    };
+    struct ClientState {
+        
+        GLenum array;
+        bool enabled;
+    };
+    
+    bool Filter(bool redundant);
+    void SetClientState(GLenum array, bool enabled);
+    bool SetPointer(Pointer& p, GLint size, GLenum type, GLsizei stride, const GLvoid* pointer);
+    
+    std::vector<ClientState> m_clientStates;
+    Pointer m_vertexPointer;
+    Pointer m_colorPointer;
+    bool m_clearColorKnown;
+    GLfloat m_clearColor[4];
+    
+    unsigned m_callCount;
+    unsigned m_filteredCount;
+    unsigned m_frameCallCount;
+    unsigned m_frameFilteredCount;
+};
+
+inline void GLState1::Invalidate() {
+    
+    m_clientStates.clear();
+    m_vertexPointer.known = false;
+    m_colorPointer.known = false;
+    m_clearColorKnown = false;
+}
+
+inline bool GLState1::Filter(bool redundant) {
+    
+    ++m_callCount;
+    if (redundant)
+        ++m_filteredCount;
+    return redundant;
+}
+
+inline void GLState1::SetClientState(GLenum array, bool enabled) {
+    
+    size_t i = 0;
+    while (i < m_clientStates.size() && m_clientStates[i].array != array)
+        ++i;
+    if (Filter(i < m_clientStates.size() && m_clientStates[i].enabled == enabled))
+        return;
+    if (enabled)
+        glEnableClientState(array);
+    else
+        glDisableClientState(array);
+    if (i == m_clientStates.size()) {
+        
+        ClientState c = { array, enabled };
+        m_clientStates.push_back(c);
+    }
+    m_clientStates[i].enabled = enabled;
+}
+
+// Records the pointer and returns whether it's new.
+inline bool GLState1::SetPointer(Pointer& p, GLint size, GLenum type, GLsizei stride, const GLvoid* pointer) {
+    
+    if (Filter(p.known && p.size == size && p.type == type && p.stride == stride && p.pointer == pointer))
+        return false;
+    p.known = true;
+    p.size = size;
+    p.type = type;
+    p.stride = stride;
+    p.pointer = pointer;
+    return true;
+}
+
+inline void GLState1::VertexPointer(GLint size, GLenum type, GLsizei stride, const GLvoid* pointer) {
+    
+    if (SetPointer(m_vertexPointer, size, type, stride, pointer))
+        glVertexPointer(size, type, stride, pointer);
+}
+
+inline void GLState1::ColorPointer(GLint size, GLenum type, GLsizei stride, const GLvoid* pointer) {
+    
+    if (SetPointer(m_colorPointer, size, type, stride, pointer))
+        glColorPointer(size, type, stride, pointer);
+}
+
+inline void GLState1::ClearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha) {
+    
+    GLfloat* c = m_clearColor;
+    if (Filter(m_clearColorKnown && c[0] == red && c[1] == green && c[2] == blue && c[3] == alpha))
+        return;
+    glClearColor(red, green, blue, alpha);
+    m_clearColorKnown = true;
+    c[0] = red;
+    c[1] = green;
+    c[2] = blue;
+    c[3] = alpha;
+}
+
+inline void GLState1::EndFrame() {
+    
+    m_frameCallCount = m_callCount;
+    m_frameFilteredCount = m_filteredCount;
+    m_callCount = 0;
+    m_filteredCount = 0;
+}
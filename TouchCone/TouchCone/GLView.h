@@ -17,10 +17,14 @@
 @private
     EAGLContext *m_context;
     IRenderingEngine *m_renderingEngine;
+    CADisplayLink *m_displayLink;
     float m_timestamp;
+    bool m_dirty;
+    int m_idleFrames;
 }
 
 - (void)drawView:(CADisplayLink *)displayLink;
 - (void)didRotate:(NSNotification *)notification;
+- (void)didHandleInput:(bool)changed;
 
 @end
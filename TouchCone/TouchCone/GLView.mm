@@ -14,6 +14,12 @@
 
 const bool ForceES1 = false;
 
+// While frames keep changing the display link fires on every refresh.  After
+// IdleFrameCount ticks with nothing to draw it only fires every
+// IdleFrameInterval refreshes, until input or the engine changes something.
+const int IdleFrameCount = 30;
+const NSInteger IdleFrameInterval = 6;
+
 @implementation GLView
 
 + (Class)layerClass {
@@ -45,7 +51,8 @@ const bool ForceES1 = false;
         if(api == kEAGLRenderingAPIOpenGLES2) {
             
             NSLog(@"Using OpenGL ES 2.0");
-            m_renderingEngine = CreateRenderEngine2();
+            NSArray *caches = NSSearchPathForDirectoriesInDomains(NSCachesDirectory, NSUserDomainMask, YES);
+            m_renderingEngine = CreateRenderEngine2([[caches firstObject] UTF8String]);
         } else {
             
             NSLog(@"Using OpenGL ES 1.1");
@@ -56,12 +63,13 @@ const bool ForceES1 = false;
         
         m_renderingEngine->Initialize(CGRectGetWidth(frame), CGRectGetHeight(frame));
         
+        m_dirty = true;
+        m_idleFrames = 0;
         [self drawView:nil];
         m_timestamp = CACurrentMediaTime();
         
-        CADisplayLink *displayLink;
-        displayLink = [CADisplayLink displayLinkWithTarget:self selector:@selector(drawView:)];
-        [displayLink addToRunLoop:[NSRunLoop currentRunLoop] forMode:NSDefaultRunLoopMode];
+        m_displayLink = [CADisplayLink displayLinkWithTarget:self selector:@selector(drawView:)];
+        [m_displayLink addToRunLoop:[NSRunLoop currentRunLoop] forMode:NSDefaultRunLoopMode];
         
         [[UIDevice currentDevice] beginGeneratingDeviceOrientationNotifications];
         
@@ -75,38 +83,60 @@ const bool ForceES1 = false;
 - (void)didRotate:(NSNotification *)notification {
     
     UIDeviceOrientation orientation = [[UIDevice currentDevice] orientation];
-    m_renderingEngine->OnRotate((DeviceOrientation)orientation);
+    [self didHandleInput:m_renderingEngine->OnRotate((DeviceOrientation)orientation)];
     [self drawView:nil];
 }
 
+// Renders and presents only when something has changed since the last
+// frame; otherwise the one on screen is still right.
 - (void)drawView:(CADisplayLink *)displayLink {
     
     if (displayLink != nil) {
         
         float elapsedSeconds = displayLink.timestamp - m_timestamp;
         m_timestamp = displayLink.timestamp;
-        m_renderingEngine->UpdateAnimation(elapsedSeconds);
+        m_dirty = m_renderingEngine->UpdateAnimation(elapsedSeconds) || m_dirty;
+    }
+    
+    if (!m_dirty) {
+        
+        if (++m_idleFrames == IdleFrameCount)
+            m_displayLink.frameInterval = IdleFrameInterval;
+        return;
     }
+    m_dirty = false;
+    m_idleFrames = 0;
+    if (m_displayLink.frameInterval != 1)
+        m_displayLink.frameInterval = 1;
     
     m_renderingEngine->Render();
     [m_context presentRenderbuffer:GL_RENDERBUFFER];
     
 }
 
+// Any input brings back the full frame rate, whether or not it changed the
+// picture, since more is likely to follow.
+- (void)didHandleInput:(bool)changed {
+    
+    m_dirty = changed || m_dirty;
+    m_idleFrames = 0;
+    m_displayLink.frameInterval = 1;
+}
+
 #pragma mark - Touch Delegate
 
 - (void) touchesBegan:(NSSet *)touches withEvent:(UIEvent *)event {
 
     UITouch *touch = [touches anyObject];
     CGPoint location = [touch locationInView:self];
-    m_renderingEngine->OnFingerUp(ivec2(location.x, location.y));
+    [self didHandleInput:m_renderingEngine->OnFingerUp(ivec2(location.x, location.y))];
 }
 
 - (void) touchesEnded:(NSSet *)touches withEvent:(UIEvent *)event {
 
     UITouch *touch = [touches anyObject];
     CGPoint location = [touch locationInView:self];
-    m_renderingEngine->OnFingerDown(ivec2(location.x, location.y));
+    [self didHandleInput:m_renderingEngine->OnFingerDown(ivec2(location.x, location.y))];
 }
 
 - (void) touchesMoved:(NSSet *)touches withEvent:(UIEvent *)event {
@@ -114,8 +144,8 @@ const bool ForceES1 = false;
     UITouch *touch = [touches anyObject];
     CGPoint previous = [touch previousLocationInView:self];
     CGPoint current = [touch locationInView:self];
-    m_renderingEngine->OnFingerMove(ivec2(previous.x, previous.y),
-                                    ivec2(current.x, current.y));
+    [self didHandleInput:m_renderingEngine->OnFingerMove(ivec2(previous.x, previous.y),
+                                                         ivec2(current.x, current.y))];
 }
 
 @end
\ No newline at end of file
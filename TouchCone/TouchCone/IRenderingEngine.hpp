@@ -23,17 +23,34 @@ enum DeviceOrientation {
 };
 
 struct IRenderingEngine* CreateRenderEngine1();
-struct IRenderingEngine* CreateRenderEngine2();
+// The ES2 engine keeps its generated meshes in cacheDirectory between
+// launches; pass null to build them every time.
+struct IRenderingEngine* CreateRenderEngine2(const char* cacheDirectory);
 
-// Interface to the OpenGL ES renderer; consumed by GLView.
+// What an engine has done, for a host that wants to log or benchmark it.
+// Fields an engine doesn't measure are 0.
+struct RenderingStats {
+    
+    unsigned MeshVertexCount;       // in the vertex buffer drawn from
+    float MeshACMRBefore;           // cache misses per triangle, as generated
+    float MeshACMRAfter;            // and after the mesh optimizer
+    bool MeshFromCache;             // mapped from the mesh cache, not built
+    unsigned StateCallCount;        // GL state changes asked for in the last frame
+    unsigned StateFilteredCount;    // how many of them were redundant and dropped
+};
+
+// Interface to the OpenGL ES renderer; consumed by GLView.  The update and
+// input handlers return whether they changed what's on screen; GLView only
+// calls Render() for a frame after one of them has.
 struct IRenderingEngine {
     virtual void Initialize(int width, int height) = 0;
     virtual void Render() const = 0;
-    virtual void UpdateAnimation(float timeStep) = 0;
-    virtual void OnRotate(DeviceOrientation newOrientation) = 0;
-    virtual void OnFingerUp(ivec2 location) = 0;
-    virtual void OnFingerDown(ivec2 location) = 0;
-    virtual void OnFingerMove(ivec2 oldLocation, ivec2 newLocation) = 0;
+    virtual bool UpdateAnimation(float timeStep) = 0;
+    virtual bool OnRotate(DeviceOrientation newOrientation) = 0;
+    virtual bool OnFingerUp(ivec2 location) = 0;
+    virtual bool OnFingerDown(ivec2 location) = 0;
+    virtual bool OnFingerMove(ivec2 oldLocation, ivec2 newLocation) = 0;
+    virtual RenderingStats GetStats() const = 0;
     virtual ~IRenderingEngine() {}
 };
 
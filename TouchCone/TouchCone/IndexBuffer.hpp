@@ -0,0 +1,184 @@
+//
+//  IndexBuffer.hpp
+//  TouchCone
+//
+//  Created by zhangdl on 25/5/14.
+//  Copyright (c) 2014 com.*. All rights reserved.
+//
+
+#pragma once
+#include <cstddef>
+#include <cstring>
+#include <stdint.h>
+#include <vector>
+
+// The values are GL_UNSIGNED_BYTE, GL_UNSIGNED_SHORT and GL_UNSIGNED_INT, so
+// a type can go straight to glDrawElements under ES1 or ES2.
+enum IndexType {
+    
+    IndexTypeByte = 0x1401,
+    IndexTypeShort = 0x1403,
+    IndexTypeInt = 0x1405,
+};
+
+// One glDrawElements call.  Indices are relative to baseVertex: point the
+// vertex attributes at that vertex before drawing, since ES has no
+// base-vertex draw.
+struct IndexBatch {
+    
+    IndexType type;
+    const void* indices;
+    int count;
+    unsigned baseVertex;
+};
+
+// Triangle-list indices stored at the narrowest width that fits the range of
+// vertices they use, relative to the smallest: bytes below 256 vertices,
+// shorts below 65536, otherwise ints when the device has
+// OES_element_index_uint.  Without it the triangles are split into batches
+// of 16-bit indices, each addressing its own window of 65536 vertices.  That
+// needs every triangle to span fewer than 65536 vertices, which holds for the
+// ParametricSurface meshes while three rows fit in that.  A triangle that
+// doesn't can't be drawn at all; Assign() leaves it out and returns false.
+class IndexBuffer {
+
+public:
+    IndexBuffer() {}
+    bool Assign(const unsigned* indices, size_t count, bool hasUintIndices);
+    
+    // Uses batches whose indices are stored elsewhere, such as in a
+    // MappedMesh, without copying them; that storage has to outlive this.
+    void Reference(const IndexBatch* batches, size_t count);
+    size_t GetBatchCount() const { return m_batches.size(); }
+    IndexBatch GetBatch(size_t i) const;
+
+private:
+    struct Batch {
+        
+        IndexType type;
+        size_t offset;
+        int count;
+        unsigned baseVertex;
+        const void* external;   // the indices, unless they're in m_data
+    };
+    template <typename Index>
+    void Append(const unsigned* indices, size_t count, unsigned baseVertex, IndexType type);
+    
+    std::vector<unsigned char> m_data;
+    std::vector<Batch> m_batches;
+};
+
+template <typename Index>
+inline void IndexBuffer::Append(const unsigned* indices, size_t count, unsigned baseVertex, IndexType type) {
+    
+    Batch batch = { type, m_data.size(), (int) count, baseVertex, 0 };
+    m_data.resize(m_data.size() + count * sizeof(Index));
+    Index* out = (Index*) &m_data[batch.offset];
+    for (size_t i = 0; i < count; ++i) {
+        out[i] = (Index) (indices[i] - baseVertex);
+    }
+    m_batches.push_back(batch);
+}
+
+inline bool IndexBuffer::Assign(const unsigned* indices, size_t count, bool hasUintIndices) {
+    
+    m_data.clear();
+    m_batches.clear();
+    if (!count)
+        return true;
+    
+    unsigned smallest = indices[0], largest = indices[0];
+    for (size_t i = 1; i < count; ++i) {
+        
+        smallest = indices[i] < smallest ? indices[i] : smallest;
+        largest = indices[i] > largest ? indices[i] : largest;
+    }
+    
+    if (largest - smallest < 0x100) {
+        Append<uint8_t>(indices, count, smallest, IndexTypeByte);
+    } else if (largest - smallest < 0x10000) {
+        Append<uint16_t>(indices, count, smallest, IndexTypeShort);
+    } else if (hasUintIndices) {
+        Append<uint32_t>(indices, count, 0, IndexTypeInt);
+    } else {
+        
+        // Gather triangles while the range they use, which may grow in
+        // either direction, still fits in 16 bits.
+        bool fits = true;
+        std::vector<unsigned> window;
+        unsigned windowLow = 0, windowHigh = 0;
+        for (size_t i = 0; i + 3 <= count; i += 3) {
+            
+            const unsigned* t = indices + i;
+            unsigned low = t[0] < t[1] ? t[0] : t[1];
+            low = t[2] < low ? t[2] : low;
+            unsigned high = t[0] > t[1] ? t[0] : t[1];
+            high = t[2] > high ? t[2] : high;
+            if (high - low > 0xFFFF) {
+                
+                fits = false;
+                continue;
+            }
+            
+            if (!window.empty()) {
+                
+                low = low < windowLow ? low : windowLow;
+                high = high > windowHigh ? high : windowHigh;
+                if (high - low > 0xFFFF) {
+                    
+                    Append<uint16_t>(&window[0], window.size(), windowLow, IndexTypeShort);
+                    window.clear();
+                    low = high = t[0];
+                    for (int k = 1; k < 3; ++k) {
+                        
+                        low = t[k] < low ? t[k] : low;
+                        high = t[k] > high ? t[k] : high;
+                    }
+                }
+            }
+            windowLow = low;
+            windowHigh = high;
+            window.insert(window.end(), t, t + 3);
+        }
+        if (!window.empty())
+            Append<uint16_t>(&window[0], window.size(), windowLow, IndexTypeShort);
+        return fits;
+    }
+    return true;
+}
+
+inline void IndexBuffer::Reference(const IndexBatch* batches, size_t count) {
+    
+    m_data.clear();
+    m_batches.clear();
+    for (size_t i = 0; i < count; ++i) {
+        
+        Batch batch = { batches[i].type, 0, batches[i].count, batches[i].baseVertex, batches[i].indices };
+        m_batches.push_back(batch);
+    }
+}
+
+inline IndexBatch IndexBuffer::GetBatch(size_t i) const {
+    
+    const Batch& batch = m_batches[i];
+    const void* indices = batch.external ? batch.external : &m_data[0] + batch.offset;
+    IndexBatch result = { batch.type, indices, batch.count, batch.baseVertex };
+    return result;
+}
+
+// True when the space-separated extensions string, from
+// glGetString(GL_EXTENSIONS), lists name.
+inline bool HasExtension(const unsigned char* extensions, const char* name) {
+    
+    if (!extensions)
+        return false;
+    
+    size_t length = std::strlen(name);
+    for (const char* p = (const char*) extensions; (p = std::strstr(p, name)); p += length) {
+        
+        bool starts = p == (const char*) extensions || p[-1] == ' ';
+        if (starts && (p[length] == ' ' || p[length] == '\0'))
+            return true;
+    }
+    return false;
+}
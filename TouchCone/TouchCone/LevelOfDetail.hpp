@@ -0,0 +1,83 @@
+//
+//  LevelOfDetail.hpp
+//  TouchCone
+//
+//  Created by zhangdl on 27/5/14.
+//  Copyright (c) 2014 com.*. All rights reserved.
+//
+
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+#include "Matrix.hpp"
+
+// Picks one of several tessellations of a mesh by how far, in pixels, its
+// coarsening can move the silhouette on screen.
+
+// Largest distance between a circle of the given radius and the polygon of
+// slices sides inscribed in it: the geometric error of a revolved surface.
+inline float ChordError(float radius, int slices) {
+    
+    return radius * (1 - std::cos(Pi / slices));
+}
+
+// Pixels covered by a length of one in object space at center, for the
+// matrices the vertex shader applies and a viewport viewportHeight pixels
+// high.  The object's scale is taken from the largest axis of modelView.
+inline float PixelsPerUnit(const mat4& modelView, const mat4& projection,
+                           const vec3& center, float viewportHeight) {
+    
+    // Clip-space w of the center, which is its distance from the eye
+    const vec4* m[4] = { &modelView.x, &modelView.y, &modelView.z, &modelView.w };
+    const float c[4] = { center.x, center.y, center.z, 1 };
+    float w = 0;
+    for (int i = 0; i < 4; ++i) {
+        
+        const vec4& row = *m[i];
+        w += c[i] * (row.x * projection.x.w + row.y * projection.y.w + row.z * projection.z.w + row.w * projection.w.w);
+    }
+    if (w <= 0)
+        return std::numeric_limits<float>::infinity();
+    
+    float scale = 0;
+    for (int i = 0; i < 3; ++i) {
+        
+        const vec4& a = *m[i];
+        scale = std::max(scale, a.x * a.x + a.y * a.y + a.z * a.z);
+    }
+    return std::sqrt(scale) * projection.y.y * viewportHeight / (2 * w);
+}
+
+// The levels are added finest first, each with its geometric error in object
+// units.  Select() returns the coarsest level whose projected error is within
+// the tolerance.  To keep a mesh near a threshold from popping back and forth
+// every frame, a coarser level is only taken once its error drops below
+// tolerance * Hysteresis; a finer one is taken as soon as it is needed.
+class LevelOfDetail {
+
+public:
+    static constexpr float Hysteresis = 0.75f;
+    
+    LevelOfDetail(float tolerance = 1) : m_tolerance(tolerance), m_current(0) {}
+    void AddLevel(float geometricError) { m_errors.push_back(geometricError); }
+    size_t GetLevelCount() const { return m_errors.size(); }
+    size_t GetCurrentLevel() const { return m_current; }
+    size_t Select(float pixelsPerUnit);
+
+private:
+    std::vector<float> m_errors;
+    float m_tolerance;
+    size_t m_current;
+};
+
+inline size_t LevelOfDetail::Select(float pixelsPerUnit) {
+    
+    while (m_current > 0 && m_errors[m_current] * pixelsPerUnit > m_tolerance)
+        --m_current;
+    while (m_current + 1 < m_errors.size() &&
+           m_errors[m_current + 1] * pixelsPerUnit <= m_tolerance * Hysteresis)
+        ++m_current;
+    return m_current;
+}
@@ -7,20 +7,19 @@
 //
 
 #pragma once
+#include <cstddef>
 #include "Vector.hpp"
+#include "Simd.hpp"
+#include "Trig.hpp"
 
 template <typename T>
 struct Matrix2 {
     
-    Matrix2() {
+    constexpr Matrix2() : x(1, 0), y(0, 1) {
         
-        x.x = 1; x.y = 0;
-        y.x = 0; y.y = 1;
     }
-    Matrix2(const T* m) {
+    constexpr Matrix2(const T* m) : x(m[0], m[1]), y(m[2], m[3]) {
         
-        x.x = m[0]; x.y = m[1];
-        y.x = m[2]; y.y = m[3];
     }
     vec2 x;
     vec2 y;
@@ -29,28 +28,20 @@ struct Matrix2 {
 template <typename T>
 struct Matrix3 {
     
-    Matrix3() {
+    constexpr Matrix3() : x(1, 0, 0), y(0, 1, 0), z(0, 0, 1) {
         
-        x.x = 1; x.y = 0; x.z = 0;
-        y.x = 0; y.y = 1; y.z = 0;
-        z.x = 0; z.y = 0; z.z = 1;
     }
-    Matrix3(const T* m) {
+    constexpr Matrix3(const T* m) : x(m[0], m[1], m[2]), y(m[3], m[4], m[5]), z(m[6], m[7], m[8]) {
         
-        x.x = m[0]; x.y = m[1]; x.z = m[2];
-        y.x = m[3]; y.y = m[4]; y.z = m[5];
-        z.x = m[6]; z.y = m[7]; z.z = m[8];
     }
-    Matrix3(vec3 x, vec3 y, vec3 z) : x(x), y(y), z(z) {
+    constexpr Matrix3(vec3 x, vec3 y, vec3 z) : x(x), y(y), z(z) {
         
     }
-    Matrix3 Transposed() const {
+    constexpr Matrix3 Transposed() const {
         
-        Matrix3 m;
-        m.x.x = x.x; m.x.y = y.x; m.x.z = z.x;
-        m.y.x = x.y; m.y.y = y.y; m.y.z = z.y;
-        m.z.x = x.z; m.z.y = y.z; m.z.z = z.z;
-        return m;
+        return Matrix3(vec3(x.x, y.x, z.x),
+                       vec3(x.y, y.y, z.y),
+                       vec3(x.z, y.z, z.z));
     }
     const T* Pointer() const {
         
@@ -61,134 +52,98 @@ struct Matrix3 {
     vec3 z;
 };
 
+// Everything except Rotate can be evaluated at compile time, so fixed
+// transforms can live in read-only data:
+//     static constexpr mat4 projection = mat4::Frustum(-1.6f, 1.6f, -2.4f, 2.4f, 5, 10);
+// The float specializations of operator* and Transposed() at the bottom of
+// this file are SIMD and run at runtime only.
 template <typename T>
 struct Matrix4 {
     
-    Matrix4() {
-        
-        x.x = 1; x.y = 0; x.z = 0; x.w = 0;
-        y.x = 0; y.y = 1; y.z = 0; y.w = 0;
-        z.x = 0; z.y = 0; z.z = 1; z.w = 0;
-        w.x = 0; w.y = 0; w.z = 0; w.w = 1;
-    }
-    Matrix4(const Matrix3<T>& m) {
-        
-        x.x = m.x.x; x.y = m.x.y; x.z = m.x.z; x.w = 0;
-        y.x = m.y.x; y.y = m.y.y; y.z = m.y.z; y.w = 0;
-        z.x = m.z.x; z.y = m.z.y; z.z = m.z.z; z.w = 0;
-        w.x = 0; w.y = 0; w.z = 0; w.w = 1;
-    }
-    Matrix4(const T* m) {
-        
-        x.x = m[0];  x.y = m[1];  x.z = m[2];  x.w = m[3];
-        y.x = m[4];  y.y = m[5];  y.z = m[6];  y.w = m[7];
-        z.x = m[8];  z.y = m[9];  z.z = m[10]; z.w = m[11];
-        w.x = m[12]; w.y = m[13]; w.z = m[14]; w.w = m[15];
-    }
-    Matrix4 operator * (const Matrix4& b) const {
-        
-        Matrix4 m;
-        m.x.x = x.x * b.x.x + x.y * b.y.x + x.z * b.z.x + x.w * b.w.x;
-        m.x.y = x.x * b.x.y + x.y * b.y.y + x.z * b.z.y + x.w * b.w.y;
-        m.x.z = x.x * b.x.z + x.y * b.y.z + x.z * b.z.z + x.w * b.w.z;
-        m.x.w = x.x * b.x.w + x.y * b.y.w + x.z * b.z.w + x.w * b.w.w;
-        m.y.x = y.x * b.x.x + y.y * b.y.x + y.z * b.z.x + y.w * b.w.x;
-        m.y.y = y.x * b.x.y + y.y * b.y.y + y.z * b.z.y + y.w * b.w.y;
-        m.y.z = y.x * b.x.z + y.y * b.y.z + y.z * b.z.z + y.w * b.w.z;
-        m.y.w = y.x * b.x.w + y.y * b.y.w + y.z * b.z.w + y.w * b.w.w;
-        m.z.x = z.x * b.x.x + z.y * b.y.x + z.z * b.z.x + z.w * b.w.x;
-        m.z.y = z.x * b.x.y + z.y * b.y.y + z.z * b.z.y + z.w * b.w.y;
-        m.z.z = z.x * b.x.z + z.y * b.y.z + z.z * b.z.z + z.w * b.w.z;
-        m.z.w = z.x * b.x.w + z.y * b.y.w + z.z * b.z.w + z.w * b.w.w;
-        m.w.x = w.x * b.x.x + w.y * b.y.x + w.z * b.z.x + w.w * b.w.x;
-        m.w.y = w.x * b.x.y + w.y * b.y.y + w.z * b.z.y + w.w * b.w.y;
-        m.w.z = w.x * b.x.z + w.y * b.y.z + w.z * b.z.z + w.w * b.w.z;
-        m.w.w = w.x * b.x.w + w.y * b.y.w + w.z * b.z.w + w.w * b.w.w;
-        return m;
+    constexpr Matrix4() : x(1, 0, 0, 0), y(0, 1, 0, 0), z(0, 0, 1, 0), w(0, 0, 0, 1) {
+        
+    }
+    constexpr Matrix4(const Matrix3<T>& m)
+        : x(m.x, 0), y(m.y, 0), z(m.z, 0), w(0, 0, 0, 1) {
+        
+    }
+    constexpr Matrix4(const T* m)
+        : x(m[0], m[1], m[2], m[3]),
+          y(m[4], m[5], m[6], m[7]),
+          z(m[8], m[9], m[10], m[11]),
+          w(m[12], m[13], m[14], m[15]) {
+        
+    }
+    constexpr Matrix4(const Vector4<T>& x, const Vector4<T>& y, const Vector4<T>& z, const Vector4<T>& w)
+        : x(x), y(y), z(z), w(w) {
+        
     }
-    Vector4<T> operator * (const Vector4<T>& b) const {
+    constexpr Matrix4 operator * (const Matrix4& b) const {
         
-        Vector4<T> v;
-        v.x = x.x * b.x + x.y * b.y + x.z * b.z + x.w * b.w;
-        v.y = y.x * b.x + y.y * b.y + y.z * b.z + y.w * b.w;
-        v.z = z.x * b.x + z.y * b.y + z.z * b.z + z.w * b.w;
-        v.w = w.x * b.x + w.y * b.y + w.z * b.z + w.w * b.w;
-        return v;
+        return Matrix4(Row(x, b), Row(y, b), Row(z, b), Row(w, b));
+    }
+    constexpr Vector4<T> operator * (const Vector4<T>& b) const {
+        
+        return Vector4<T>(x.x * b.x + x.y * b.y + x.z * b.z + x.w * b.w,
+                          y.x * b.x + y.y * b.y + y.z * b.z + y.w * b.w,
+                          z.x * b.x + z.y * b.y + z.z * b.z + z.w * b.w,
+                          w.x * b.x + w.y * b.y + w.z * b.z + w.w * b.w);
     }
     Matrix4& operator *= (const Matrix4& b){
         
         Matrix4 m = *this * b;
         return (*this = m);
     }
-    Matrix4 Transposed() const {
+    constexpr Matrix4 Transposed() const {
         
-        Matrix4 m;
-        m.x.x = x.x; m.x.y = y.x; m.x.z = z.x; m.x.w = w.x;
-        m.y.x = x.y; m.y.y = y.y; m.y.z = z.y; m.y.w = w.y;
-        m.z.x = x.z; m.z.y = y.z; m.z.z = z.z; m.z.w = w.z;
-        m.w.x = x.w; m.w.y = y.w; m.w.z = z.w; m.w.w = w.w;
-        return m;
+        return Matrix4(Vector4<T>(x.x, y.x, z.x, w.x),
+                       Vector4<T>(x.y, y.y, z.y, w.y),
+                       Vector4<T>(x.z, y.z, z.z, w.z),
+                       Vector4<T>(x.w, y.w, z.w, w.w));
     }
-    Matrix3<T> ToMat3() const {
+    constexpr Matrix3<T> ToMat3() const {
         
-        Matrix3<T> m;
-        m.x.x = x.x; m.y.x = y.x; m.z.x = z.x;
-        m.x.y = x.y; m.y.y = y.y; m.z.y = z.y;
-        m.x.z = x.z; m.y.z = y.z; m.z.z = z.z;
-        return m;
+        return Matrix3<T>(vec3(x.x, x.y, x.z),
+                          vec3(y.x, y.y, y.z),
+                          vec3(z.x, z.y, z.z));
     }
     const T* Pointer() const{
         
         return &x.x;
     }
 #warning why this method use static
-    static Matrix4<T> Identity() {
+    static constexpr Matrix4<T> Identity() {
         
         return Matrix4();
     }
     
-    static Matrix4<T> Translate (const Vector3<T>& v) {
-        
-        Matrix4 m;
-        m.x.x = 1; m.x.y = 0; m.x.z = 0; m.x.w = 0;
-        m.y.x = 0; m.y.y = 1; m.y.z = 0; m.y.w = 0;
-        m.z.x = 0; m.z.y = 0; m.z.z = 1; m.z.w = 0;
-        m.w.x = v.x; m.w.y = v.y; m.w.z = v.z; m.w.w = 1;
-        return m;
+    static constexpr Matrix4<T> Translate (const Vector3<T>& v) {
         
+        return Translate(v.x, v.y, v.z);
     }
-    static Matrix4<T> Translate (T x, T y, T z) {
+    static constexpr Matrix4<T> Translate (T x, T y, T z) {
         
-        Matrix4 m;
-        m.x.x = 1; m.x.y = 0; m.x.z = 0; m.x.w = 0;
-        m.y.x = 0; m.y.y = 1; m.y.z = 0; m.y.w = 0;
-        m.z.x = 0; m.z.y = 0; m.z.z = 1; m.z.w = 0;
-        m.w.x = x; m.w.y = y; m.w.z = z; m.w.w = 1;
-        return m;
+        return Matrix4(Vector4<T>(1, 0, 0, 0),
+                       Vector4<T>(0, 1, 0, 0),
+                       Vector4<T>(0, 0, 1, 0),
+                       Vector4<T>(x, y, z, 1));
     }
-    static Matrix4<T> Scale (T s) {
+    static constexpr Matrix4<T> Scale (T s) {
         
-        Matrix4 m;
-        m.x.x = s; m.x.y = 0; m.x.z = 0; m.x.w = 0;
-        m.y.x = 0; m.y.y = s; m.y.z = 0; m.y.w = 0;
-        m.z.x = 0; m.z.y = 0; m.z.z = s; m.z.w = 0;
-        m.w.x = 0; m.w.y = 0; m.w.z = 0; m.w.w = 1;
-        return m;
+        return Scale(s, s, s);
     }
-    static Matrix4<T> Scale (T x, T y, T z) {
+    static constexpr Matrix4<T> Scale (T x, T y, T z) {
         
-        Matrix4 m;
-        m.x.x = x; m.x.y = 0; m.x.z = 0; m.x.w = 0;
-        m.y.x = 0; m.y.y = y; m.y.z = 0; m.y.w = 0;
-        m.z.x = 0; m.z.y = 0; m.z.z = z; m.z.w = 0;
-        m.w.x = 0; m.w.y = 0; m.w.z = 0; m.w.w = 1;
-        return m;
+        return Matrix4(Vector4<T>(x, 0, 0, 0),
+                       Vector4<T>(0, y, 0, 0),
+                       Vector4<T>(0, 0, z, 0),
+                       Vector4<T>(0, 0, 0, 1));
     }
     static Matrix4<T> Rotate (T degrees) {
         
         T radians = degrees * 3.14159f / 180.0f;
-        T s = std::sin(radians);
-        T c = std::cos(radians);
+        T s, c;
+        SinCos(radians, s, c);
         
         Matrix4 m = Identity();
         m.x.x = c; m.x.y = s;
@@ -198,8 +153,8 @@ struct Matrix4 {
     static Matrix4<T> Rotate (T degrees, const vec3& axis) {
         
         T radians = degrees * 3.14159f / 180.0f;
-        T s = std::sin(radians);
-        T c = std::cos(radians);
+        T s, c;
+        SinCos(radians, s, c);
         
         Matrix4 m = Identity();
         m.x.x = c + (1 - c) * axis.x * axis.x;
@@ -213,44 +168,283 @@ struct Matrix4 {
         m.z.z = c + (1 - c) * axis.z * axis.z;
         return m;
     }
-    static Matrix4<T> Ortho(T left, T right, T bottom, T top, T near, T far) {
+    static constexpr Matrix4<T> Ortho(T left, T right, T bottom, T top, T near, T far) {
         
-        T a = 2.0f / (right - left);
-        T b = 2.0f / (top - bottom);
-        T c = -2.0f / (far - near);
-        T tx = (right + left) / (right - left);
-        T ty = (top + bottom) / (top - bottom);
-        T tz = (far + near) / (far - near);
-        
-        Matrix4 m;
-        m.x.x = a; m.x.y = 0; m.x.z = 0; m.x.w = 0;
-        m.y.x = 0; m.y.y = b; m.y.z = 0; m.y.w = 0;
-        m.z.x = 0; m.z.y = 0; m.z.z = 0; m.z.w = 0;
-        m.w.x = tx; m.w.y = ty; m.w.z = tz; m.w.w = 1;
-        return m;
+        return Matrix4(Vector4<T>(2.0f / (right - left), 0, 0, 0),
+                       Vector4<T>(0, 2.0f / (top - bottom), 0, 0),
+                       Vector4<T>(0, 0, 0, 0),
+                       Vector4<T>((right + left) / (right - left),
+                                  (top + bottom) / (top - bottom),
+                                  (far + near) / (far - near),
+                                  1));
     }
 #warning 练习推导
-    static Matrix4<T> Frustum(T left, T right, T bottom, T top, T near, T far) {
-        
-        T a = 2 * near / (right - left);
-        T b = 2 * near / (top - bottom);
-        T c = (right + left) / (right - left);
-        T d = (top + bottom) / (top - bottom);
-        T e = - (far + near) / (far - near);
-        T f = -2 * far * near / (far - near);
-        Matrix4 m;
-        m.x.x = a; m.x.y = 0; m.x.z = 0; m.x.w = 0;
-        m.y.x = 0; m.y.y = b; m.y.z = 0; m.y.w = 0;
-        m.z.x = c; m.z.y = d; m.z.z = e; m.z.w = -1;
-        m.w.x = 0; m.w.y = 0; m.w.z = f; m.w.w = 1;
-        return m;
+    static constexpr Matrix4<T> Frustum(T left, T right, T bottom, T top, T near, T far) {
+        
+        return Matrix4(Vector4<T>(2 * near / (right - left), 0, 0, 0),
+                       Vector4<T>(0, 2 * near / (top - bottom), 0, 0),
+                       Vector4<T>((right + left) / (right - left),
+                                  (top + bottom) / (top - bottom),
+                                  -(far + near) / (far - near),
+                                  -1),
+                       Vector4<T>(0, 0, -2 * far * near / (far - near), 1));
     }
     vec4 x;
     vec4 y;
     vec4 z;
     vec4 w;
+    
+private:
+    static constexpr Vector4<T> Row(const Vector4<T>& a, const Matrix4& b) {
+        
+        return Vector4<T>(a.x * b.x.x + a.y * b.y.x + a.z * b.z.x + a.w * b.w.x,
+                          a.x * b.x.y + a.y * b.y.y + a.z * b.z.y + a.w * b.w.y,
+                          a.x * b.x.z + a.y * b.y.z + a.z * b.z.z + a.w * b.w.z,
+                          a.x * b.x.w + a.y * b.y.w + a.z * b.z.w + a.w * b.w.w);
+    }
 };
 
+// An affine transform stored like the top three columns of a Matrix4: x, y
+// and z are the rows of the linear part and w is the translation.  Composing
+// two of them costs 36 multiplies instead of 64 because the constant 0 0 0 1
+// column is never touched.  Conventions match Matrix4 and the vertex shader:
+// (a * b).ToMat4() == a.ToMat4() * b.ToMat4(), and TransformPoint(p) is what
+// the shader computes for p once ToMat4() has been uploaded.
+template <typename T>
+struct Affine3 {
+    
+    constexpr Affine3() : x(1, 0, 0), y(0, 1, 0), z(0, 0, 1), w(0, 0, 0) {
+        
+    }
+    constexpr Affine3(const Vector3<T>& x, const Vector3<T>& y, const Vector3<T>& z, const Vector3<T>& w)
+        : x(x), y(y), z(z), w(w) {
+        
+    }
+    constexpr Affine3(const Matrix3<T>& m, const Vector3<T>& translation)
+        : x(m.x), y(m.y), z(m.z), w(translation) {
+        
+    }
+    // Drops the projective column, which must be 0 0 0 1.
+    constexpr explicit Affine3(const Matrix4<T>& m)
+        : x(m.x.x, m.x.y, m.x.z), y(m.y.x, m.y.y, m.y.z), z(m.z.x, m.z.y, m.z.z), w(m.w.x, m.w.y, m.w.z) {
+        
+    }
+    constexpr Affine3 operator * (const Affine3& b) const {
+        
+        return Affine3(b.TransformVector(x),
+                       b.TransformVector(y),
+                       b.TransformVector(z),
+                       b.TransformPoint(w));
+    }
+    Affine3& operator *= (const Affine3& b) {
+        
+        return (*this = *this * b);
+    }
+    constexpr Vector3<T> TransformPoint(const Vector3<T>& p) const {
+        
+        return Vector3<T>(p.x * x.x + p.y * y.x + p.z * z.x + w.x,
+                          p.x * x.y + p.y * y.y + p.z * z.y + w.y,
+                          p.x * x.z + p.y * y.z + p.z * z.z + w.z);
+    }
+    constexpr Vector3<T> TransformVector(const Vector3<T>& v) const {
+        
+        return Vector3<T>(v.x * x.x + v.y * y.x + v.z * z.x,
+                          v.x * x.y + v.y * y.y + v.z * z.y,
+                          v.x * x.z + v.y * y.z + v.z * z.z);
+    }
+    Affine3 Inverted() const {
+        
+        // Rows of the inverse linear part come from the cofactors.
+        Vector3<T> cx = y.Cross(z);
+        Vector3<T> cy = z.Cross(x);
+        Vector3<T> cz = x.Cross(y);
+        T s = 1 / x.Dot(cx);
+        
+        Affine3 m(Vector3<T>(cx.x, cy.x, cz.x) * s,
+                  Vector3<T>(cx.y, cy.y, cz.y) * s,
+                  Vector3<T>(cx.z, cy.z, cz.z) * s,
+                  Vector3<T>(0, 0, 0));
+        m.w = -m.TransformVector(w);
+        return m;
+    }
+    // Cheaper inverse when the linear part is a pure rotation.
+    constexpr Affine3 InvertedRigid() const {
+        
+        return Affine3(Vector3<T>(x.x, y.x, z.x),
+                       Vector3<T>(x.y, y.y, z.y),
+                       Vector3<T>(x.z, y.z, z.z),
+                       Vector3<T>(-w.Dot(x), -w.Dot(y), -w.Dot(z)));
+    }
+    constexpr Matrix4<T> ToMat4() const {
+        
+        return Matrix4<T>(Vector4<T>(x, 0), Vector4<T>(y, 0), Vector4<T>(z, 0), Vector4<T>(w, 1));
+    }
+    static constexpr Affine3 Translate(T x, T y, T z) {
+        
+        return Affine3(Vector3<T>(1, 0, 0), Vector3<T>(0, 1, 0), Vector3<T>(0, 0, 1), Vector3<T>(x, y, z));
+    }
+    static constexpr Affine3 Scale(T s) {
+        
+        return Affine3(Vector3<T>(s, 0, 0), Vector3<T>(0, s, 0), Vector3<T>(0, 0, s), Vector3<T>(0, 0, 0));
+    }
+    Vector3<T> x;
+    Vector3<T> y;
+    Vector3<T> z;
+    Vector3<T> w;
+};
+
+#if VECTORMATH_SIMD
+// Vectorized kernels for the float matrices we upload every frame.  Each one
+// adds the products in the same order as the generic template above, so the
+// results are identical; build with VECTORMATH_SCALAR to get the template back.
+template <>
+inline Matrix4<float> Matrix4<float>::operator * (const Matrix4<float>& b) const {
+    
+    Simd::float4 bx = Simd::Load(&b.x.x);
+    Simd::float4 by = Simd::Load(&b.y.x);
+    Simd::float4 bz = Simd::Load(&b.z.x);
+    Simd::float4 bw = Simd::Load(&b.w.x);
+    
+    Matrix4 m;
+    Simd::Store(&m.x.x, Simd::Combine(&x.x, bx, by, bz, bw));
+    Simd::Store(&m.y.x, Simd::Combine(&y.x, bx, by, bz, bw));
+    Simd::Store(&m.z.x, Simd::Combine(&z.x, bx, by, bz, bw));
+    Simd::Store(&m.w.x, Simd::Combine(&w.x, bx, by, bz, bw));
+    return m;
+}
+
+template <>
+inline Vector4<float> Matrix4<float>::operator * (const Vector4<float>& b) const {
+    
+    Simd::float4 c0 = Simd::Load(&x.x);
+    Simd::float4 c1 = Simd::Load(&y.x);
+    Simd::float4 c2 = Simd::Load(&z.x);
+    Simd::float4 c3 = Simd::Load(&w.x);
+    Simd::Transpose(c0, c1, c2, c3);
+    
+    Vector4<float> v;
+    Simd::Store(&v.x, Simd::Combine(&b.x, c0, c1, c2, c3));
+    return v;
+}
+
+template <>
+inline Matrix4<float> Matrix4<float>::Transposed() const {
+    
+    Simd::float4 r0 = Simd::Load(&x.x);
+    Simd::float4 r1 = Simd::Load(&y.x);
+    Simd::float4 r2 = Simd::Load(&z.x);
+    Simd::float4 r3 = Simd::Load(&w.x);
+    Simd::Transpose(r0, r1, r2, r3);
+    
+    Matrix4 m;
+    Simd::Store(&m.x.x, r0);
+    Simd::Store(&m.y.x, r1);
+    Simd::Store(&m.z.x, r2);
+    Simd::Store(&m.w.x, r3);
+    return m;
+}
+#endif
+
 typedef Matrix2<float> mat2;
 typedef Matrix3<float> mat3;
 typedef Matrix4<float> mat4;
+typedef Affine3<float> affine3;
+
+// Batch transforms for vertex and bounding-volume data.  Results follow the
+// vertex shader's convention once m is uploaded with glUniformMatrix4fv, so
+// each output is m.Transposed() * vec4(p, 1), not m * vec4(p, 1).  The AoS
+// overloads take a byte stride so they can walk a field of an interleaved
+// vertex, e.g. TransformPoints(m, &vertices[0].Position, sizeof(Vertex), ...).
+inline void TransformPoints(const mat4& m, const vec3* in, size_t stride, vec4* out, size_t count) {
+    
+    Simd::float4 r0 = Simd::Load(&m.x.x);
+    Simd::float4 r1 = Simd::Load(&m.y.x);
+    Simd::float4 r2 = Simd::Load(&m.z.x);
+    Simd::float4 r3 = Simd::Load(&m.w.x);
+    
+    const char* src = (const char*)in;
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4, src += 4 * stride) {
+        
+        Simd::float4 v0 = Simd::CombinePoint((const float*)src, r0, r1, r2, r3);
+        Simd::float4 v1 = Simd::CombinePoint((const float*)(src + stride), r0, r1, r2, r3);
+        Simd::float4 v2 = Simd::CombinePoint((const float*)(src + 2 * stride), r0, r1, r2, r3);
+        Simd::float4 v3 = Simd::CombinePoint((const float*)(src + 3 * stride), r0, r1, r2, r3);
+        Simd::Store(&out[i].x, v0);
+        Simd::Store(&out[i + 1].x, v1);
+        Simd::Store(&out[i + 2].x, v2);
+        Simd::Store(&out[i + 3].x, v3);
+    }
+    for (; i < count; ++i, src += stride) {
+        
+        Simd::Store(&out[i].x, Simd::CombinePoint((const float*)src, r0, r1, r2, r3));
+    }
+}
+
+inline void TransformPoints(const mat4& m, const vec3* in, vec4* out, size_t count) {
+    
+    TransformPoints(m, in, sizeof(vec3), out, count);
+}
+
+inline void TransformPoints(const mat4& m, const vec4* in, vec4* out, size_t count) {
+    
+    Simd::float4 r0 = Simd::Load(&m.x.x);
+    Simd::float4 r1 = Simd::Load(&m.y.x);
+    Simd::float4 r2 = Simd::Load(&m.z.x);
+    Simd::float4 r3 = Simd::Load(&m.w.x);
+    
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        
+        Simd::float4 v0 = Simd::Combine(&in[i].x, r0, r1, r2, r3);
+        Simd::float4 v1 = Simd::Combine(&in[i + 1].x, r0, r1, r2, r3);
+        Simd::float4 v2 = Simd::Combine(&in[i + 2].x, r0, r1, r2, r3);
+        Simd::float4 v3 = Simd::Combine(&in[i + 3].x, r0, r1, r2, r3);
+        Simd::Store(&out[i].x, v0);
+        Simd::Store(&out[i + 1].x, v1);
+        Simd::Store(&out[i + 2].x, v2);
+        Simd::Store(&out[i + 3].x, v3);
+    }
+    for (; i < count; ++i) {
+        
+        Simd::Store(&out[i].x, Simd::Combine(&in[i].x, r0, r1, r2, r3));
+    }
+}
+
+// SoA variant: one stream per component, four points per vector op.  Output
+// streams may alias the inputs.
+inline void TransformPoints(const mat4& m,
+                            const float* inX, const float* inY, const float* inZ,
+                            float* outX, float* outY, float* outZ, float* outW,
+                            size_t count) {
+    
+    const float* r = m.Pointer();
+    float* out[4] = { outX, outY, outZ, outW };
+    
+    Simd::float4 c[16];
+    for (int k = 0; k < 16; ++k) {
+        c[k] = Simd::Splat(r[k]);
+    }
+    
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        
+        Simd::float4 x = Simd::Load(inX + i);
+        Simd::float4 y = Simd::Load(inY + i);
+        Simd::float4 z = Simd::Load(inZ + i);
+        for (int k = 0; k < 4; ++k) {
+            
+            Simd::float4 v = Simd::Mul(x, c[k]);
+            v = Simd::MulAdd(y, c[4 + k], v);
+            v = Simd::MulAdd(z, c[8 + k], v);
+            Simd::Store(out[k] + i, Simd::Add(v, c[12 + k]));
+        }
+    }
+    for (; i < count; ++i) {
+        
+        float x = inX[i], y = inY[i], z = inZ[i];
+        for (int k = 0; k < 4; ++k) {
+            out[k][i] = x * r[k] + y * r[4 + k] + z * r[8 + k] + r[12 + k];
+        }
+    }
+}
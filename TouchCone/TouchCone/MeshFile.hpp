@@ -0,0 +1,302 @@
+//
+//  MeshFile.hpp
+//  TouchCone
+//
+//  Created by zhangdl on 29/5/14.
+//  Copyright (c) 2014 com.*. All rights reserved.
+//
+
+#pragma once
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <stdint.h>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+#include "IndexBuffer.hpp"
+
+// A finished mesh on disk, laid out exactly as it is drawn so that loading
+// it is an mmap and a pass of range checks:
+//
+//     MeshFileHeader
+//     vertices        VertexCount * VertexStride bytes, described by Attributes
+//     MeshFileBatch   BatchCount records, grouped by IndexBuffer
+//     indices         each batch at its own width, as IndexBuffer stores it
+//
+// Every section starts on a MeshFileAlignment boundary.  Fields are in the
+// writing device's byte order; the file is a cache, not an exchange format.
+// Key identifies what the mesh was built from (see HashBytes) and a file
+// whose key or version differs is ignored, so changing any generator
+// parameter simply rebuilds it.  The parameters don't cover the code, so
+// keys also start from MeshGeneratorVersion.
+
+const uint32_t MeshFileMagic = 0x4853454D;     // "MESH"
+const uint32_t MeshFileVersion = 1;
+
+// Bump whenever ParametricSurface, MeshOptimizer or a mesh's builder would
+// turn the same parameters into different vertices or indices.
+const uint32_t MeshGeneratorVersion = 2;
+const uint32_t MeshFileAlignment = 16;
+const int MaxMeshAttributes = 8;
+
+// glVertexAttribPointer's arguments for one attribute, less the stride.
+struct MeshAttribute {
+    
+    uint32_t Size;
+    uint32_t Type;
+    uint32_t Normalized;
+    uint32_t Offset;
+};
+
+struct MeshFileHeader {
+    
+    uint32_t Magic;
+    uint32_t Version;
+    uint64_t Key;
+    uint32_t VertexCount;
+    uint32_t VertexStride;
+    uint32_t AttributeCount;
+    uint32_t GroupCount;
+    uint32_t BatchCount;
+    uint32_t Reserved;
+    uint64_t VertexOffset;
+    uint64_t BatchOffset;
+    uint64_t IndexOffset;
+    uint64_t FileSize;
+    MeshAttribute Attributes[MaxMeshAttributes];
+};
+
+// One IndexBatch; Offset is in bytes from the start of the index section.
+struct MeshFileBatch {
+    
+    uint32_t Group;
+    uint32_t Type;
+    uint32_t Count;
+    uint32_t BaseVertex;
+    uint64_t Offset;
+};
+
+// FNV-1a, 64 bits.  Chain calls through hash to combine several values.
+inline uint64_t HashBytes(const void* data, size_t size, uint64_t hash = 14695981039346656037ull) {
+    
+    const unsigned char* bytes = (const unsigned char*) data;
+    for (size_t i = 0; i < size; ++i) {
+        hash = (hash ^ bytes[i]) * 1099511628211ull;
+    }
+    return hash;
+}
+
+inline size_t IndexSize(IndexType type) {
+    
+    return type == IndexTypeByte ? 1 : type == IndexTypeShort ? 2 : 4;
+}
+
+inline uint64_t AlignMeshFileOffset(uint64_t offset) {
+    
+    return (offset + MeshFileAlignment - 1) & ~(uint64_t) (MeshFileAlignment - 1);
+}
+
+// Writes vertexCount vertices of stride bytes and the batches of groupCount
+// index buffers.  The file is written under a temporary name and renamed into
+// place, so a reader never maps half a mesh.  Returns false on any I/O error.
+inline bool WriteMeshFile(const char* path, uint64_t key,
+                          const void* vertices, uint32_t vertexCount, uint32_t stride,
+                          const MeshAttribute* attributes, uint32_t attributeCount,
+                          const IndexBuffer* groups, uint32_t groupCount) {
+    
+    if (attributeCount > MaxMeshAttributes)
+        return false;
+    
+    MeshFileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    header.Magic = MeshFileMagic;
+    header.Version = MeshFileVersion;
+    header.Key = key;
+    header.VertexCount = vertexCount;
+    header.VertexStride = stride;
+    header.AttributeCount = attributeCount;
+    header.GroupCount = groupCount;
+    std::memcpy(header.Attributes, attributes, attributeCount * sizeof(MeshAttribute));
+    
+    std::vector<MeshFileBatch> batches;
+    uint64_t indexSize = 0;
+    for (uint32_t g = 0; g < groupCount; ++g) {
+        
+        for (size_t i = 0; i < groups[g].GetBatchCount(); ++i) {
+            
+            IndexBatch batch = groups[g].GetBatch(i);
+            MeshFileBatch record = { g, (uint32_t) batch.type, (uint32_t) batch.count, batch.baseVertex, indexSize };
+            batches.push_back(record);
+            indexSize = AlignMeshFileOffset(indexSize + batch.count * IndexSize(batch.type));
+        }
+    }
+    header.BatchCount = batches.size();
+    header.VertexOffset = AlignMeshFileOffset(sizeof(header));
+    header.BatchOffset = AlignMeshFileOffset(header.VertexOffset + (uint64_t) vertexCount * stride);
+    header.IndexOffset = AlignMeshFileOffset(header.BatchOffset + batches.size() * sizeof(MeshFileBatch));
+    header.FileSize = header.IndexOffset + indexSize;
+    
+    // Assemble the whole file, then write it in one go.
+    std::vector<unsigned char> file(header.FileSize, 0);
+    std::memcpy(&file[0], &header, sizeof(header));
+    std::memcpy(&file[header.VertexOffset], vertices, (size_t) vertexCount * stride);
+    if (!batches.empty())
+        std::memcpy(&file[header.BatchOffset], &batches[0], batches.size() * sizeof(MeshFileBatch));
+    for (size_t b = 0, g = 0, i = 0; b < batches.size(); ++b, ++i) {
+        
+        while (i == groups[g].GetBatchCount()) {
+            
+            ++g;
+            i = 0;
+        }
+        IndexBatch batch = groups[g].GetBatch(i);
+        std::memcpy(&file[header.IndexOffset + batches[b].Offset], batch.indices, batch.count * IndexSize(batch.type));
+    }
+    
+    std::string temporary = std::string(path) + ".tmp";
+    FILE* out = std::fopen(temporary.c_str(), "wb");
+    if (!out)
+        return false;
+    bool written = std::fwrite(&file[0], file.size(), 1, out) == 1;
+    written = std::fclose(out) == 0 && written;
+    if (!written || std::rename(temporary.c_str(), path)) {
+        
+        std::remove(temporary.c_str());
+        return false;
+    }
+    return true;
+}
+
+// A mesh file mapped read-only.  Open() checks the header, that every
+// section lies inside the file and that every index drawn lands on a vertex;
+// after that the vertices and indices are used in place, straight from the
+// mapped pages.
+class MappedMesh {
+
+public:
+    MappedMesh() : m_data(0), m_size(0) {}
+    ~MappedMesh() { Close(); }
+    bool Open(const char* path, uint64_t key);
+    void Close();
+    bool IsOpen() const { return m_data != 0; }
+    const MeshFileHeader& GetHeader() const { return *(const MeshFileHeader*) m_data; }
+    const unsigned char* GetVertices() const { return m_data + GetHeader().VertexOffset; }
+    
+    // Points indices at group's batches, without copying them.
+    void GetIndices(uint32_t group, IndexBuffer& indices) const;
+
+private:
+    MappedMesh(const MappedMesh&);
+    MappedMesh& operator = (const MappedMesh&);
+    bool IsValid(uint64_t key) const;
+    const MeshFileBatch* GetBatches() const { return (const MeshFileBatch*) (m_data + GetHeader().BatchOffset); }
+    
+    const unsigned char* m_data;
+    size_t m_size;
+};
+
+inline bool MappedMesh::Open(const char* path, uint64_t key) {
+    
+    Close();
+    int file = open(path, O_RDONLY);
+    if (file < 0)
+        return false;
+    
+    struct stat status;
+    if (fstat(file, &status) == 0 && status.st_size >= (off_t) sizeof(MeshFileHeader)) {
+        
+        void* data = mmap(0, status.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+        if (data != MAP_FAILED) {
+            
+            m_data = (const unsigned char*) data;
+            m_size = status.st_size;
+        }
+    }
+    close(file);
+    
+    if (m_data && !IsValid(key))
+        Close();
+    return m_data != 0;
+}
+
+inline void MappedMesh::Close() {
+    
+    if (m_data)
+        munmap((void*) m_data, m_size);
+    m_data = 0;
+    m_size = 0;
+}
+
+// The largest of count indices of the given type.
+inline uint32_t MaxIndex(const unsigned char* indices, IndexType type, uint32_t count) {
+    
+    uint32_t largest = 0;
+    for (uint32_t i = 0; i < count; ++i) {
+        
+        uint32_t index = type == IndexTypeByte ? indices[i]
+                       : type == IndexTypeShort ? ((const uint16_t*) indices)[i]
+                       : ((const uint32_t*) indices)[i];
+        largest = index > largest ? index : largest;
+    }
+    return largest;
+}
+
+// Every size is compared against the room left rather than added to an
+// offset, so no field, however large, can wrap the arithmetic.
+inline bool MappedMesh::IsValid(uint64_t key) const {
+    
+    const MeshFileHeader& header = GetHeader();
+    if (header.Magic != MeshFileMagic || header.Version != MeshFileVersion || header.Key != key ||
+        header.FileSize != m_size || header.AttributeCount > MaxMeshAttributes)
+        return false;
+    
+    // Sections in order, aligned and inside the file.
+    uint64_t offsets = header.VertexOffset | header.BatchOffset | header.IndexOffset;
+    if (offsets % MeshFileAlignment || header.VertexOffset < sizeof(MeshFileHeader) ||
+        header.BatchOffset < header.VertexOffset || header.IndexOffset < header.BatchOffset ||
+        header.IndexOffset > m_size)
+        return false;
+    if ((uint64_t) header.VertexCount * header.VertexStride > header.BatchOffset - header.VertexOffset ||
+        (uint64_t) header.BatchCount * sizeof(MeshFileBatch) > header.IndexOffset - header.BatchOffset)
+        return false;
+    
+    // Each batch inside the index section, and every vertex it draws inside
+    // the vertex section, so GL never reads past either buffer.
+    uint64_t indexBytes = m_size - header.IndexOffset;
+    const MeshFileBatch* batches = GetBatches();
+    for (uint32_t i = 0; i < header.BatchCount; ++i) {
+        
+        const MeshFileBatch& batch = batches[i];
+        IndexType type = (IndexType) batch.Type;
+        if (type != IndexTypeByte && type != IndexTypeShort && type != IndexTypeInt)
+            return false;
+        if (batch.Group >= header.GroupCount || batch.Count > 0x7FFFFFFF ||
+            batch.BaseVertex >= header.VertexCount || batch.Offset % IndexSize(type) ||
+            batch.Offset > indexBytes || (uint64_t) batch.Count * IndexSize(type) > indexBytes - batch.Offset)
+            return false;
+        const unsigned char* indices = m_data + header.IndexOffset + batch.Offset;
+        if (batch.Count && MaxIndex(indices, type, batch.Count) >= header.VertexCount - batch.BaseVertex)
+            return false;
+    }
+    return true;
+}
+
+inline void MappedMesh::GetIndices(uint32_t group, IndexBuffer& indices) const {
+    
+    std::vector<IndexBatch> batches;
+    const MeshFileHeader& header = GetHeader();
+    for (uint32_t i = 0; i < header.BatchCount; ++i) {
+        
+        const MeshFileBatch& record = GetBatches()[i];
+        if (record.Group != group)
+            continue;
+        IndexBatch batch = {
+            (IndexType) record.Type, m_data + header.IndexOffset + record.Offset, (int) record.Count, record.BaseVertex,
+        };
+        batches.push_back(batch);
+    }
+    indices.Reference(batches.empty() ? 0 : &batches[0], batches.size());
+}
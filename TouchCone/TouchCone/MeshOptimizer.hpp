@@ -0,0 +1,314 @@
+//
+//  MeshOptimizer.hpp
+//  TouchCone
+//
+//  Created by zhangdl on 26/5/14.
+//  Copyright (c) 2014 com.*. All rights reserved.
+//
+
+#pragma once
+#include <algorithm>
+#include <cstring>
+#include <vector>
+#include "Vector.hpp"
+
+// Load-time passes over an indexed triangle list, run after the geometry is
+// generated and before it is packed and uploaded.  Each one keeps the index
+// count and rewrites the indices in place.  Vertex is any plain struct with
+// a vec3 Position member.
+
+// Post-transform cache size the passes optimize for.  The SGX's cache is
+// small and FIFO-like, and a smaller target costs little on bigger caches.
+const int VertexCacheSize = 16;
+
+// Average cache misses per triangle for a FIFO cache of the given size:
+// 3 means no reuse at all, 0.5 is about the best a regular grid can do.
+inline float ComputeACMR(const unsigned* indices, size_t indexCount, size_t vertexCount,
+                         int cacheSize = VertexCacheSize) {
+    
+    if (indexCount < 3)
+        return 0;
+    
+    // A vertex is cached if it was loaded within the last cacheSize misses.
+    std::vector<size_t> loadedAt(vertexCount, 0);
+    size_t misses = 0;
+    for (size_t i = 0; i < indexCount; ++i) {
+        
+        unsigned v = indices[i];
+        if (!loadedAt[v] || misses - loadedAt[v] >= (size_t) cacheSize) {
+            
+            ++misses;
+            loadedAt[v] = misses;
+        }
+    }
+    return (float) misses / (indexCount / 3);
+}
+
+// Merges vertices whose bytes are identical, found through an open-addressed
+// hash table, and returns the new vertex count.  Survivors keep their
+// relative order.  Note that 0 and -0 differ bitwise.
+template <typename Vertex>
+inline size_t WeldVertices(std::vector<Vertex>& vertices, unsigned* indices, size_t indexCount) {
+    
+    size_t count = vertices.size();
+    size_t tableSize = 1;
+    while (tableSize < count * 2)
+        tableSize *= 2;
+    
+    const unsigned Empty = ~0u;
+    std::vector<unsigned> table(tableSize, Empty);
+    std::vector<unsigned> remap(count);
+    size_t unique = 0;
+    for (size_t i = 0; i < count; ++i) {
+        
+        // FNV-1a over the vertex's bytes
+        const unsigned char* bytes = (const unsigned char*) &vertices[i];
+        unsigned hash = 2166136261u;
+        for (size_t b = 0; b < sizeof(Vertex); ++b) {
+            hash = (hash ^ bytes[b]) * 16777619u;
+        }
+        
+        size_t slot = hash & (tableSize - 1);
+        while (table[slot] != Empty && std::memcmp(&vertices[table[slot]], bytes, sizeof(Vertex)))
+            slot = (slot + 1) & (tableSize - 1);
+        
+        if (table[slot] == Empty) {
+            
+            vertices[unique] = vertices[i];
+            table[slot] = (unsigned) unique++;
+        }
+        remap[i] = table[slot];
+    }
+    
+    for (size_t i = 0; i < indexCount; ++i) {
+        indices[i] = remap[indices[i]];
+    }
+    vertices.resize(unique);
+    return unique;
+}
+
+// Reorders triangles for the post-transform cache with Tipsify (Sander,
+// Nehab and Barczak, "Fast Triangle Reordering for Vertex Locality and
+// Reduced Overdraw", 2007): fan around one vertex at a time and move on to a
+// neighbour that is still in the cache.  When it has to jump to a vertex
+// outside the cache it starts a new cluster; the index offset of every
+// cluster goes to clusters, for OptimizeOverdraw.
+inline void OptimizeVertexCache(unsigned* indices, size_t indexCount, size_t vertexCount,
+                                std::vector<size_t>* clusters = 0, int cacheSize = VertexCacheSize) {
+    
+    size_t triangleCount = indexCount / 3;
+    if (clusters)
+        clusters->assign(1, 0);
+    if (!triangleCount)
+        return;
+    
+    // Triangles around each vertex, as offsets into adjacency.
+    std::vector<unsigned> live(vertexCount, 0);
+    for (size_t i = 0; i < indexCount; ++i) {
+        ++live[indices[i]];
+    }
+    std::vector<size_t> first(vertexCount + 1, 0);
+    for (size_t v = 0; v < vertexCount; ++v) {
+        first[v + 1] = first[v] + live[v];
+    }
+    std::vector<unsigned> adjacency(indexCount);
+    std::vector<size_t> fill(first.begin(), first.end() - 1);
+    for (size_t i = 0; i < indexCount; ++i) {
+        adjacency[fill[indices[i]]++] = (unsigned) (i / 3);
+    }
+    
+    std::vector<unsigned> output;
+    output.reserve(indexCount);
+    std::vector<size_t> cachedAt(vertexCount, 0);
+    std::vector<bool> emitted(triangleCount, false);
+    std::vector<unsigned> deadEnd;
+    std::vector<unsigned> candidates;
+    size_t time = cacheSize + 1;
+    size_t cursor = 0;
+    long fan = indices[0];
+    
+    while (fan >= 0) {
+        
+        // Emit every remaining triangle around the fanning vertex.
+        candidates.clear();
+        for (size_t a = first[fan]; a < first[fan + 1]; ++a) {
+            
+            unsigned t = adjacency[a];
+            if (emitted[t])
+                continue;
+            
+            for (int k = 0; k < 3; ++k) {
+                
+                unsigned v = indices[3 * t + k];
+                output.push_back(v);
+                deadEnd.push_back(v);
+                candidates.push_back(v);
+                --live[v];
+                if (time - cachedAt[v] > (size_t) cacheSize)
+                    cachedAt[v] = time++;
+            }
+            emitted[t] = true;
+        }
+        
+        // Next, the candidate that will still be cached after its own
+        // triangles are emitted, preferring the one that entered first.  A
+        // candidate that won't be has no priority and is never picked here.
+        long next = -1;
+        size_t best = 0;
+        for (size_t c = 0; c < candidates.size(); ++c) {
+            
+            unsigned v = candidates[c];
+            if (!live[v])
+                continue;
+            size_t priority = 0;
+            if (time - cachedAt[v] + 2 * live[v] <= (size_t) cacheSize)
+                priority = time - cachedAt[v];
+            if (priority > best) {
+                
+                best = priority;
+                next = v;
+            }
+        }
+        
+        // Otherwise back up through recently used vertices, then scan.
+        if (next < 0) {
+            
+            while (!deadEnd.empty() && next < 0) {
+                
+                unsigned v = deadEnd.back();
+                deadEnd.pop_back();
+                if (live[v])
+                    next = v;
+            }
+            while (next < 0 && cursor < vertexCount) {
+                
+                if (live[cursor])
+                    next = (long) cursor;
+                ++cursor;
+            }
+            if (next >= 0 && clusters && time - cachedAt[next] > (size_t) cacheSize)
+                clusters->push_back(output.size());
+        }
+        fan = next;
+    }
+    std::copy(output.begin(), output.end(), indices);
+}
+
+// Sorts the clusters from OptimizeVertexCache so that those facing away from
+// the mesh's center, which tend to occlude the rest, draw first ("Fast
+// Triangle Reordering", section 4).  The order within a cluster is kept, so
+// cache efficiency barely changes.
+template <typename Vertex>
+inline void OptimizeOverdraw(unsigned* indices, size_t indexCount, const std::vector<Vertex>& vertices,
+                             const std::vector<size_t>& clusters) {
+    
+    if (clusters.size() < 2)
+        return;
+    
+    // Area-weighted centroid and normal per cluster, and of the whole mesh.
+    size_t clusterCount = clusters.size();
+    std::vector<vec3> centroids(clusterCount, vec3(0, 0, 0));
+    std::vector<vec3> normals(clusterCount, vec3(0, 0, 0));
+    std::vector<float> areas(clusterCount, 0);
+    vec3 center(0, 0, 0);
+    float totalArea = 0;
+    for (size_t c = 0; c < clusterCount; ++c) {
+        
+        size_t end = c + 1 < clusterCount ? clusters[c + 1] : indexCount;
+        for (size_t i = clusters[c]; i + 3 <= end; i += 3) {
+            
+            const vec3& p0 = vertices[indices[i]].Position;
+            const vec3& p1 = vertices[indices[i + 1]].Position;
+            const vec3& p2 = vertices[indices[i + 2]].Position;
+            vec3 normal = (p1 - p0).Cross(p2 - p0);
+            float area = normal.Length();
+            vec3 centroid = (p0 + p1 + p2) * (area / 3);
+            centroids[c] += centroid;
+            normals[c] += normal;
+            areas[c] += area;
+            center += centroid;
+            totalArea += area;
+        }
+    }
+    if (totalArea > 0)
+        center = center * (1 / totalArea);
+    
+    std::vector<std::pair<float, size_t> > order(clusterCount);
+    for (size_t c = 0; c < clusterCount; ++c) {
+        
+        vec3 centroid = areas[c] > 0 ? centroids[c] * (1 / areas[c]) : center;
+        order[c] = std::make_pair(-(centroid - center).Dot(normals[c]), c);
+    }
+    std::stable_sort(order.begin(), order.end());
+    
+    std::vector<unsigned> sorted;
+    sorted.reserve(indexCount);
+    for (size_t k = 0; k < clusterCount; ++k) {
+        
+        size_t c = order[k].second;
+        size_t end = c + 1 < clusterCount ? clusters[c + 1] : indexCount;
+        sorted.insert(sorted.end(), indices + clusters[c], indices + end);
+    }
+    std::copy(sorted.begin(), sorted.end(), indices);
+}
+
+// Renumbers the vertices in the order the indices first use them, so fetches
+// walk the vertex buffer forwards, and drops unreferenced vertices.  Returns
+// the new vertex count.
+template <typename Vertex>
+inline size_t OptimizeVertexFetch(std::vector<Vertex>& vertices, unsigned* indices, size_t indexCount) {
+    
+    const unsigned Unused = ~0u;
+    std::vector<unsigned> remap(vertices.size(), Unused);
+    std::vector<Vertex> ordered;
+    ordered.reserve(vertices.size());
+    for (size_t i = 0; i < indexCount; ++i) {
+        
+        unsigned& v = remap[indices[i]];
+        if (v == Unused) {
+            
+            v = (unsigned) ordered.size();
+            ordered.push_back(vertices[indices[i]]);
+        }
+        indices[i] = v;
+    }
+    vertices.swap(ordered);
+    return vertices.size();
+}
+
+struct MeshReport {
+    
+    size_t vertexCountBefore;
+    size_t vertexCountAfter;
+    float acmrBefore;
+    float acmrAfter;
+};
+
+// All of the above in order.  The indices may hold several groups that are
+// drawn separately, given by groupSizes; triangles are only reordered within
+// their group and the groups keep their sizes and offsets.
+template <typename Vertex>
+inline MeshReport OptimizeMesh(std::vector<Vertex>& vertices, std::vector<unsigned>& indices,
+                               const size_t* groupSizes, size_t groupCount) {
+    
+    MeshReport report = { vertices.size(), vertices.size(), 0, 0 };
+    if (indices.empty())
+        return report;
+    report.acmrBefore = ComputeACMR(&indices[0], indices.size(), vertices.size());
+    
+    WeldVertices(vertices, &indices[0], indices.size());
+    
+    std::vector<size_t> clusters;
+    for (size_t g = 0, offset = 0; g < groupCount; offset += groupSizes[g++]) {
+        
+        unsigned* group = &indices[0] + offset;
+        OptimizeVertexCache(group, groupSizes[g], vertices.size(), &clusters);
+        OptimizeOverdraw(group, groupSizes[g], vertices, clusters);
+    }
+    
+    OptimizeVertexFetch(vertices, &indices[0], indices.size());
+    
+    report.vertexCountAfter = vertices.size();
+    report.acmrAfter = ComputeACMR(&indices[0], indices.size(), vertices.size());
+    return report;
+}
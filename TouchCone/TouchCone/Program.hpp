@@ -0,0 +1,242 @@
+//
+//  Program.hpp
+//  TouchCone
+//
+//  Created by zhangdl on 1/6/14.
+//  Copyright (c) 2014 com.*. All rights reserved.
+//
+
+#pragma once
+#include <cstring>
+#include <stdint.h>
+#include <vector>
+#include "GLES2.hpp"
+#include "Matrix.hpp"
+
+typedef uint32_t NameHash;
+
+// FNV-1a, 32 bits, of a shader variable's name.  It's constexpr so names
+// written in the code are hashed by the compiler, not on every lookup.
+constexpr NameHash HashName(const char* name, NameHash hash = 2166136261u) {
+    
+    return *name ? HashName(name + 1, (hash ^ (unsigned char) *name) * 16777619u) : hash;
+}
+
+// A linked program with every active attribute and uniform looked up once,
+// straight after linking, instead of by name each frame.  Uniform values are
+// shadowed, so setting one to the value it already has costs a compare and
+// no GL call.  The shadows assume the program is only changed through
+// SetUniform(), and that it's the current program whenever that is called.
+class Program {
+
+public:
+    Program() : m_handle(0) {}
+    ~Program() { Release(); }
+    
+    // Takes ownership of a linked program and reflects it.
+    void Attach(GLuint handle);
+    void Release();
+    GLuint GetHandle() const { return m_handle; }
+    
+    // Attribute location, or -1 if the attribute isn't active.
+    GLint GetAttribute(NameHash name) const;
+    
+    // Index for SetUniform(), or -1 if the uniform isn't active.  An array is
+    // found by its name without the "[0]".
+    int GetUniform(NameHash name) const;
+    
+    // Each sets the whole uniform: values holds every component of every
+    // element, a matrix column by column, as glUniform*v expects.  A -1
+    // uniform is ignored, like a -1 location.
+    void SetUniform(int uniform, const GLfloat* values) const;
+    void SetUniform(int uniform, const GLint* values) const;
+    void SetUniform(int uniform, const mat4& value) const { SetUniform(uniform, value.Pointer()); }
+    void SetUniform(int uniform, GLfloat value) const { SetUniform(uniform, &value); }
+    void SetUniform(int uniform, GLint value) const { SetUniform(uniform, &value); }
+
+private:
+    Program(const Program&);
+    Program& operator = (const Program&);
+    
+    struct Attribute {
+        
+        NameHash name;
+        GLint location;
+    };
+    struct Uniform {
+        
+        NameHash name;
+        GLint location;
+        GLenum type;
+        GLint size;
+        GLint components;
+        size_t shadow;
+    };
+    
+    static GLint GetComponentCount(GLenum type);
+    static bool IsFloat(GLenum type);
+    template <typename T> bool Shadow(int uniform, std::vector<T>& shadows, const T* values) const;
+    
+    GLuint m_handle;
+    std::vector<Attribute> m_attributes;
+    std::vector<Uniform> m_uniforms;
+    
+    // Last values uploaded, by Uniform::shadow, and which uniforms have had
+    // one at all.
+    mutable std::vector<bool> m_known;
+    mutable std::vector<GLfloat> m_floats;
+    mutable std::vector<GLint> m_ints;
+};
+
+inline void Program::Attach(GLuint handle) {
+    
+    Release();
+    m_handle = handle;
+    
+    GLint count = 0, maxLength = 0;
+    glGetProgramiv(handle, GL_ACTIVE_ATTRIBUTES, &count);
+    glGetProgramiv(handle, GL_ACTIVE_ATTRIBUTE_MAX_LENGTH, &maxLength);
+    std::vector<GLchar> name(maxLength + 1);
+    for (GLint i = 0; i < count; ++i) {
+        
+        GLint size;
+        GLenum type;
+        glGetActiveAttrib(handle, i, name.size(), 0, &size, &type, &name[0]);
+        
+        // Built-in attributes have no location.
+        Attribute attribute = { HashName(&name[0]), glGetAttribLocation(handle, &name[0]) };
+        if (attribute.location >= 0)
+            m_attributes.push_back(attribute);
+    }
+    
+    glGetProgramiv(handle, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(handle, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+    name.resize(maxLength + 1);
+    size_t floats = 0, ints = 0;
+    for (GLint i = 0; i < count; ++i) {
+        
+        Uniform uniform;
+        glGetActiveUniform(handle, i, name.size(), 0, &uniform.size, &uniform.type, &name[0]);
+        uniform.location = glGetUniformLocation(handle, &name[0]);
+        if (uniform.location < 0)
+            continue;
+        
+        char* element = std::strstr(&name[0], "[0]");
+        if (element)
+            *element = 0;
+        uniform.name = HashName(&name[0]);
+        uniform.components = GetComponentCount(uniform.type);
+        size_t& shadows = IsFloat(uniform.type) ? floats : ints;
+        uniform.shadow = shadows;
+        shadows += uniform.components * uniform.size;
+        m_uniforms.push_back(uniform);
+    }
+    m_known.assign(m_uniforms.size(), false);
+    m_floats.assign(floats, 0);
+    m_ints.assign(ints, 0);
+}
+
+inline void Program::Release() {
+    
+    if (m_handle)
+        glDeleteProgram(m_handle);
+    m_handle = 0;
+    m_attributes.clear();
+    m_uniforms.clear();
+    m_known.clear();
+    m_floats.clear();
+    m_ints.clear();
+}
+
+inline GLint Program::GetAttribute(NameHash name) const {
+    
+    for (size_t i = 0; i < m_attributes.size(); ++i) {
+        
+        if (m_attributes[i].name == name)
+            return m_attributes[i].location;
+    }
+    return -1;
+}
+
+inline int Program::GetUniform(NameHash name) const {
+    
+    for (size_t i = 0; i < m_uniforms.size(); ++i) {
+        
+        if (m_uniforms[i].name == name)
+            return i;
+    }
+    return -1;
+}
+
+inline GLint Program::GetComponentCount(GLenum type) {
+    
+    switch (type) {
+        case GL_FLOAT_VEC2: case GL_INT_VEC2: case GL_BOOL_VEC2: return 2;
+        case GL_FLOAT_VEC3: case GL_INT_VEC3: case GL_BOOL_VEC3: return 3;
+        case GL_FLOAT_VEC4: case GL_INT_VEC4: case GL_BOOL_VEC4: case GL_FLOAT_MAT2: return 4;
+        case GL_FLOAT_MAT3: return 9;
+        case GL_FLOAT_MAT4: return 16;
+        default: return 1;
+    }
+}
+
+inline bool Program::IsFloat(GLenum type) {
+    
+    switch (type) {
+        case GL_FLOAT: case GL_FLOAT_VEC2: case GL_FLOAT_VEC3: case GL_FLOAT_VEC4:
+        case GL_FLOAT_MAT2: case GL_FLOAT_MAT3: case GL_FLOAT_MAT4:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// Copies values over the uniform's shadow and returns whether they differed.
+template <typename T>
+inline bool Program::Shadow(int uniform, std::vector<T>& shadows, const T* values) const {
+    
+    const Uniform& u = m_uniforms[uniform];
+    T* shadow = &shadows[u.shadow];
+    size_t bytes = u.components * u.size * sizeof(T);
+    if (m_known[uniform] && !std::memcmp(shadow, values, bytes))
+        return false;
+    std::memcpy(shadow, values, bytes);
+    m_known[uniform] = true;
+    return true;
+}
+
+inline void Program::SetUniform(int uniform, const GLfloat* values) const {
+    
+    if (uniform < 0)
+        return;
+    const Uniform& u = m_uniforms[uniform];
+    if (!IsFloat(u.type) || !Shadow(uniform, m_floats, values))
+        return;
+    
+    switch (u.type) {
+        case GL_FLOAT: glUniform1fv(u.location, u.size, values); break;
+        case GL_FLOAT_VEC2: glUniform2fv(u.location, u.size, values); break;
+        case GL_FLOAT_VEC3: glUniform3fv(u.location, u.size, values); break;
+        case GL_FLOAT_VEC4: glUniform4fv(u.location, u.size, values); break;
+        case GL_FLOAT_MAT2: glUniformMatrix2fv(u.location, u.size, GL_FALSE, values); break;
+        case GL_FLOAT_MAT3: glUniformMatrix3fv(u.location, u.size, GL_FALSE, values); break;
+        case GL_FLOAT_MAT4: glUniformMatrix4fv(u.location, u.size, GL_FALSE, values); break;
+    }
+}
+
+// Integers, booleans and samplers.
+inline void Program::SetUniform(int uniform, const GLint* values) const {
+    
+    if (uniform < 0)
+        return;
+    const Uniform& u = m_uniforms[uniform];
+    if (IsFloat(u.type) || !Shadow(uniform, m_ints, values))
+        return;
+    
+    switch (u.components) {
+        case 1: glUniform1iv(u.location, u.size, values); break;
+        case 2: glUniform2iv(u.location, u.size, values); break;
+        case 3: glUniform3iv(u.location, u.size, values); break;
+        case 4: glUniform4iv(u.location, u.size, values); break;
+    }
+}
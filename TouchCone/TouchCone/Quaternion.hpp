@@ -7,6 +7,7 @@
 //
 #pragma once
 #include "Matrix.hpp"
+#include "Simd.hpp"
 
 template <typename T>
 struct QuaternionT {
@@ -16,19 +17,20 @@ struct QuaternionT {
     T z;
     T w;
     
-    QuaternionT();
-    QuaternionT(T x, T y, T z, T w);
+    constexpr QuaternionT();
+    constexpr QuaternionT(T x, T y, T z, T w);
     
     QuaternionT<T> Slerp(T mu, const QuaternionT<T>& q) const;
     QuaternionT<T> Rotated(const QuaternionT<T>& b) const;
-    QuaternionT<T> Scaled(T scale) const;
-    T Dot(const QuaternionT<T>& q) const;
+    constexpr QuaternionT<T> Scaled(T scale) const;
+    constexpr T Dot(const QuaternionT<T>& q) const;
     Matrix3<T> ToMatrix() const;
-    Vector4<T> ToVector() const;
-    QuaternionT<T> operator+(const QuaternionT<T>& q) const;
-    QuaternionT<T> operator-(const QuaternionT<T>& q) const;
-    bool operator==(const QuaternionT<T>& q) const;
-    bool operator!=(const QuaternionT<T>& q) const;
+    constexpr Vector4<T> ToVector() const;
+    constexpr QuaternionT<T> operator+(const QuaternionT<T>& q) const;
+    constexpr QuaternionT<T> operator-(const QuaternionT<T>& q) const;
+    constexpr QuaternionT<T> operator*(const QuaternionT<T>& q) const;
+    constexpr bool operator==(const QuaternionT<T>& q) const;
+    constexpr bool operator!=(const QuaternionT<T>& q) const;
     
     void Normalize();
     void Rotate(const QuaternionT<T>& q);
@@ -38,11 +40,11 @@ struct QuaternionT {
 };
 
 template <typename T>
-inline QuaternionT<T>::QuaternionT() : x(0), y(0), z(0), w(1) {
+constexpr QuaternionT<T>::QuaternionT() : x(0), y(0), z(0), w(1) {
 }
 
 template <typename T>
-inline QuaternionT<T>::QuaternionT(T x, T y, T z, T w) : x(x), y(y), z(z), w(w) {
+constexpr QuaternionT<T>::QuaternionT(T x, T y, T z, T w) : x(x), y(y), z(z), w(w) {
 }
 
 // Ken Shoemake's famous method.
@@ -88,13 +90,13 @@ inline QuaternionT<T> QuaternionT<T>::Rotated(const QuaternionT<T>& b) const
 }
 
 template <typename T>
-inline QuaternionT<T> QuaternionT<T>::Scaled(T s) const
+constexpr QuaternionT<T> QuaternionT<T>::Scaled(T s) const
 {
     return QuaternionT<T>(x * s, y * s, z * s, w * s);
 }
 
 template <typename T>
-inline T QuaternionT<T>::Dot(const QuaternionT<T>& q) const
+constexpr T QuaternionT<T>::Dot(const QuaternionT<T>& q) const
 {
     return x * q.x + y * q.y + z * q.z + w * q.w;
 }
@@ -119,31 +121,41 @@ inline Matrix3<T> QuaternionT<T>::ToMatrix() const
 }
 
 template <typename T>
-inline Vector4<T> QuaternionT<T>::ToVector() const
+constexpr Vector4<T> QuaternionT<T>::ToVector() const
 {
     return Vector4<T>(x, y, z, w);
 }
 
 template <typename T>
-QuaternionT<T> QuaternionT<T>::operator-(const QuaternionT<T>& q) const
+constexpr QuaternionT<T> QuaternionT<T>::operator-(const QuaternionT<T>& q) const
 {
     return QuaternionT<T>(x - q.x, y - q.y, z - q.z, w - q.w);
 }
 
 template <typename T>
-QuaternionT<T> QuaternionT<T>::operator+(const QuaternionT<T>& q) const
+constexpr QuaternionT<T> QuaternionT<T>::operator+(const QuaternionT<T>& q) const
 {
     return QuaternionT<T>(x + q.x, y + q.y, z + q.z, w + q.w);
 }
 
+// The Hamilton product, like Rotated but without renormalizing.
 template <typename T>
-bool QuaternionT<T>::operator==(const QuaternionT<T>& q) const
+constexpr QuaternionT<T> QuaternionT<T>::operator*(const QuaternionT<T>& b) const
+{
+    return QuaternionT<T>(w * b.x + x * b.w + y * b.z - z * b.y,
+                          w * b.y + y * b.w + z * b.x - x * b.z,
+                          w * b.z + z * b.w + x * b.y - y * b.x,
+                          w * b.w - x * b.x - y * b.y - z * b.z);
+}
+
+template <typename T>
+constexpr bool QuaternionT<T>::operator==(const QuaternionT<T>& q) const
 {
     return x == q.x && y == q.y && z == q.z && w == q.w;
 }
 
 template <typename T>
-bool QuaternionT<T>::operator!=(const QuaternionT<T>& q) const
+constexpr bool QuaternionT<T>::operator!=(const QuaternionT<T>& q) const
 {
     return !(*this == q);
 }
@@ -172,8 +184,8 @@ template <typename T>
 inline QuaternionT<T>  QuaternionT<T>::CreateFromAxisAngle(const Vector3<T>& axis, float radians)
 {
     QuaternionT<T> q;
-    q.w = std::cos(radians / 2);
-    q.x = q.y = q.z = std::sin(radians / 2);
+    SinCos(radians / 2, q.x, q.w);
+    q.y = q.z = q.x;
     q.x *= axis.x;
     q.y *= axis.y;
     q.z *= axis.z;
@@ -202,3 +214,483 @@ inline void QuaternionT<T>::Rotate(const QuaternionT<T>& q2)
 }
 
 typedef QuaternionT<float> Quaternion;
+
+// A rotation followed by a translation, stored as real + dual * epsilon with
+// dual = translation * real / 2.  Unlike matrices, a weighted sum of these is
+// still rigid once normalized, so blending never shrinks or shears a limb
+// (Kavan et al., "Geometric Skinning with Approximate Dual Quaternion
+// Blending", 2008).  Composition follows Affine3:
+// (a * b).TransformPoint(p) == b.TransformPoint(a.TransformPoint(p)).
+template <typename T>
+struct DualQuaternionT {
+    
+    QuaternionT<T> real;
+    QuaternionT<T> dual;
+    
+    constexpr DualQuaternionT();
+    constexpr DualQuaternionT(const QuaternionT<T>& real, const QuaternionT<T>& dual);
+    constexpr DualQuaternionT(const QuaternionT<T>& rotation, const Vector3<T>& translation);
+    
+    constexpr DualQuaternionT<T> Scaled(T scale) const;
+    constexpr DualQuaternionT<T> operator+(const DualQuaternionT<T>& q) const;
+    constexpr DualQuaternionT<T> operator*(const DualQuaternionT<T>& q) const;
+    Vector3<T> Translation() const;
+    Vector3<T> TransformVector(const Vector3<T>& v) const;
+    Vector3<T> TransformPoint(const Vector3<T>& p) const;
+    Matrix4<T> ToMatrix() const;
+    
+    void Normalize();
+    
+    static DualQuaternionT<T> Blend(const DualQuaternionT<T>* q, const T* weights, int count);
+};
+
+template <typename T>
+constexpr DualQuaternionT<T>::DualQuaternionT() : real(), dual(0, 0, 0, 0) {
+}
+
+template <typename T>
+constexpr DualQuaternionT<T>::DualQuaternionT(const QuaternionT<T>& real, const QuaternionT<T>& dual)
+    : real(real), dual(dual) {
+}
+
+template <typename T>
+constexpr DualQuaternionT<T>::DualQuaternionT(const QuaternionT<T>& rotation, const Vector3<T>& t)
+    : real(rotation), dual((QuaternionT<T>(t.x, t.y, t.z, 0) * rotation).Scaled(T(0.5))) {
+}
+
+template <typename T>
+constexpr DualQuaternionT<T> DualQuaternionT<T>::Scaled(T s) const
+{
+    return DualQuaternionT<T>(real.Scaled(s), dual.Scaled(s));
+}
+
+template <typename T>
+constexpr DualQuaternionT<T> DualQuaternionT<T>::operator+(const DualQuaternionT<T>& q) const
+{
+    return DualQuaternionT<T>(real + q.real, dual + q.dual);
+}
+
+template <typename T>
+constexpr DualQuaternionT<T> DualQuaternionT<T>::operator*(const DualQuaternionT<T>& b) const
+{
+    return DualQuaternionT<T>(b.real * real, b.real * dual + b.dual * real);
+}
+
+// The vector part of 2 * dual * conjugate(real).
+template <typename T>
+inline Vector3<T> DualQuaternionT<T>::Translation() const
+{
+    const QuaternionT<T>& r = real;
+    const QuaternionT<T>& d = dual;
+    return Vector3<T>(2 * (r.w * d.x - d.w * r.x + r.y * d.z - r.z * d.y),
+                      2 * (r.w * d.y - d.w * r.y + r.z * d.x - r.x * d.z),
+                      2 * (r.w * d.z - d.w * r.z + r.x * d.y - r.y * d.x));
+}
+
+// Rotation only; the dual quaternion must be normalized.
+template <typename T>
+inline Vector3<T> DualQuaternionT<T>::TransformVector(const Vector3<T>& v) const
+{
+    Vector3<T> axis(real.x, real.y, real.z);
+    Vector3<T> a = axis.Cross(v) + v * real.w;
+    return v + axis.Cross(a) * 2;
+}
+
+template <typename T>
+inline Vector3<T> DualQuaternionT<T>::TransformPoint(const Vector3<T>& p) const
+{
+    return TransformVector(p) + Translation();
+}
+
+template <typename T>
+inline Matrix4<T> DualQuaternionT<T>::ToMatrix() const
+{
+    Matrix4<T> m(real.ToMatrix());
+    m.w = Vector4<T>(Translation(), 1);
+    return m;
+}
+
+// Makes real unit length and dual orthogonal to it.
+template <typename T>
+inline void DualQuaternionT<T>::Normalize()
+{
+    T s = 1 / std::sqrt(real.Dot(real));
+    real = real.Scaled(s);
+    dual = dual.Scaled(s);
+    dual = dual - real.Scaled(real.Dot(dual));
+}
+
+// Normalized weighted sum.  Any q[i] whose real part is in the other
+// hemisphere from q[0]'s is negated first, so the blend takes the short way.
+template <typename T>
+inline DualQuaternionT<T> DualQuaternionT<T>::Blend(const DualQuaternionT<T>* q, const T* weights, int count)
+{
+    DualQuaternionT<T> b = q[0].Scaled(weights[0]);
+    for (int i = 1; i < count; ++i) {
+        
+        T w = weights[i];
+        if (q[i].real.Dot(q[0].real) < 0)
+            w = -w;
+        b = b + q[i].Scaled(w);
+    }
+    b.Normalize();
+    return b;
+}
+
+typedef DualQuaternionT<float> DualQuaternion;
+
+// Structure-of-arrays view over many quaternions, for the batch functions below.
+template <typename P>
+struct QuaternionArrayT {
+    
+    QuaternionArrayT(P* x, P* y, P* z, P* w) : x(x), y(y), z(z), w(w) {}
+    template <typename Q>
+    QuaternionArrayT(const QuaternionArrayT<Q>& a) : x(a.x), y(a.y), z(a.z), w(a.w) {}
+    P* x;
+    P* y;
+    P* z;
+    P* w;
+};
+
+typedef QuaternionArrayT<float> QuaternionArray;
+typedef QuaternionArrayT<const float> ConstQuaternionArray;
+
+enum QuaternionBlend {
+    
+    QuaternionBlendNlerp,
+    QuaternionBlendSlerp,
+};
+
+// Blends four quaternion pairs at once, lane by lane.  Neither mode calls a
+// trig function; both take the shorter arc, so a negative dot flips b.
+//
+// Nlerp: normalized lerp with t warped by a cubic fitted to the slerp angle
+// curve (Kapoulkine's "onlerp" correction), then one rsqrt.  Within 4e-4
+// (xyzw distance) of the exact slerp over the whole range.
+//
+// Slerp: Eberly's eight-term polynomial for sin(t * theta) / sin(theta) in
+// cos(theta) ("A Fast and Accurate Algorithm for Computing SLERP", 2011).
+// Within 3e-5 of the exact slerp everywhere, and of QuaternionT::Slerp
+// wherever that takes its trig path (0 <= dot < 1 - 0.0005).  There is no
+// special case near dot == 1.
+inline void BlendQuaternions4(QuaternionBlend mode,
+                              Simd::float4* a, Simd::float4* b, Simd::float4 t,
+                              Simd::float4* out) {
+    
+    using namespace Simd;
+    float4 dot = Mul(a[0], b[0]);
+    dot = MulAdd(a[1], b[1], dot);
+    dot = MulAdd(a[2], b[2], dot);
+    dot = MulAdd(a[3], b[3], dot);
+    for (int i = 0; i < 4; ++i) {
+        b[i] = FlipSign(b[i], dot);
+    }
+    float4 d = Abs(dot);
+    float4 one = Splat(1);
+    
+    if (mode == QuaternionBlendNlerp) {
+        
+        float4 ka = MulAdd(d, Splat(-1.43519f), Splat(3.55645f));
+        ka = MulAdd(d, ka, Splat(-3.2452f));
+        ka = MulAdd(d, ka, Splat(1.0904f));
+        float4 kb = MulAdd(d, Splat(0.215638f), Splat(-1.06021f));
+        kb = MulAdd(d, kb, Splat(0.848013f));
+        
+        float4 h = Sub(t, Splat(0.5f));
+        float4 k = MulAdd(Mul(ka, h), h, kb);
+        float4 warped = MulAdd(Mul(Mul(t, h), Sub(t, one)), k, t);
+        
+        float4 q[4];
+        for (int i = 0; i < 4; ++i) {
+            q[i] = MulAdd(Sub(b[i], a[i]), warped, a[i]);
+        }
+        float4 n = Mul(q[0], q[0]);
+        n = MulAdd(q[1], q[1], n);
+        n = MulAdd(q[2], q[2], n);
+        n = Rsqrt(MulAdd(q[3], q[3], n));
+        for (int i = 0; i < 4; ++i) {
+            out[i] = Mul(q[i], n);
+        }
+        return;
+    }
+    
+    // u[i] = 1 / ((i + 1) * (2i + 3)), v[i] = (i + 1) / (2i + 3); the last
+    // pair is scaled by mu = 1.85298109 to absorb the truncated tail.
+    static const float u[8] = {
+        1.0f / 3, 1.0f / 10, 1.0f / 21, 1.0f / 36,
+        1.0f / 55, 1.0f / 78, 1.0f / 105, 1.85298109240830f / 136,
+    };
+    static const float v[8] = {
+        1.0f / 3, 2.0f / 5, 3.0f / 7, 4.0f / 9,
+        5.0f / 11, 6.0f / 13, 7.0f / 15, 1.85298109240830f * 8 / 17,
+    };
+    
+    float4 xm1 = Sub(d, one);
+    float4 s = Sub(one, t);
+    float4 t2 = Mul(t, t);
+    float4 s2 = Mul(s, s);
+    float4 f0 = one;
+    float4 f1 = one;
+    for (int i = 7; i >= 0; --i) {
+        
+        float4 ui = Splat(u[i]);
+        float4 vi = Splat(v[i]);
+        f0 = MulAdd(Mul(Sub(Mul(ui, s2), vi), xm1), f0, one);
+        f1 = MulAdd(Mul(Sub(Mul(ui, t2), vi), xm1), f1, one);
+    }
+    f0 = Mul(f0, s);
+    f1 = Mul(f1, t);
+    for (int i = 0; i < 4; ++i) {
+        out[i] = MulAdd(b[i], f1, Mul(a[i], f0));
+    }
+}
+
+// out[i] = blend of a[i] and b[i] at t[i], four quaternions per iteration.
+// The inputs must be unit length; out may alias a or b.
+inline void BlendQuaternions(QuaternionBlend mode,
+                             ConstQuaternionArray a, ConstQuaternionArray b,
+                             const float* t, QuaternionArray out, size_t count) {
+    
+    const float* src[8] = { a.x, a.y, a.z, a.w, b.x, b.y, b.z, b.w };
+    float* dst[4] = { out.x, out.y, out.z, out.w };
+    Simd::float4 qa[4], qb[4], q[4];
+    
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        
+        for (int k = 0; k < 4; ++k) {
+            
+            qa[k] = Simd::Load(src[k] + i);
+            qb[k] = Simd::Load(src[4 + k] + i);
+        }
+        BlendQuaternions4(mode, qa, qb, Simd::Load(t + i), q);
+        for (int k = 0; k < 4; ++k) {
+            Simd::Store(dst[k] + i, q[k]);
+        }
+    }
+    if (i == count)
+        return;
+    
+    // Pad the tail out to a full vector with identity blends.
+    float tail[9][4];
+    for (int k = 0; k < 9; ++k) {
+        
+        for (int j = 0; j < 4; ++j) {
+            
+            float pad = (k == 3 || k == 7) ? 1.0f : 0.0f;
+            const float* from = (k < 8) ? src[k] : t;
+            tail[k][j] = (i + j < count) ? from[i + j] : pad;
+        }
+    }
+    for (int k = 0; k < 4; ++k) {
+        
+        qa[k] = Simd::Load(tail[k]);
+        qb[k] = Simd::Load(tail[4 + k]);
+    }
+    BlendQuaternions4(mode, qa, qb, Simd::Load(tail[8]), q);
+    for (int k = 0; k < 4; ++k) {
+        
+        Simd::Store(tail[k], q[k]);
+        for (size_t j = 0; i + j < count; ++j) {
+            dst[k][i + j] = tail[k][j];
+        }
+    }
+}
+
+// Skinning.  Each vertex has four bone indices and weights; unused slots
+// need a weight of 0 but any valid index.  Bones are the full skinning
+// transforms: the bone's current pose composed after the inverse of its
+// bind pose.
+enum Skinning {
+    
+    SkinningDualQuaternion,
+    SkinningMatrix,
+};
+
+// Packs the palette that SkinVertices and the vertex shader read.  Upload it
+// with glUniform4fv(slot, count * <vec4s per bone>, &palette[0].x).
+//
+// Dual quaternions take two vec4s per bone, real then dual.  Matrices take
+// three: the rows of the 3x4 matrix that maps vec4(p, 1) to the skinned
+// point, so the shader computes dot(Bones[3 * i + k], vec4(p, 1)).
+inline void PackPalette(const DualQuaternion* bones, size_t count, vec4* palette) {
+    
+    for (size_t i = 0; i < count; ++i) {
+        
+        const DualQuaternion& q = bones[i];
+        palette[2 * i] = q.real.ToVector();
+        palette[2 * i + 1] = q.dual.ToVector();
+    }
+}
+
+inline void PackPalette(const affine3* bones, size_t count, vec4* palette) {
+    
+    for (size_t i = 0; i < count; ++i) {
+        
+        const affine3& m = bones[i];
+        palette[3 * i] = vec4(m.x.x, m.y.x, m.z.x, m.w.x);
+        palette[3 * i + 1] = vec4(m.x.y, m.y.y, m.z.y, m.w.y);
+        palette[3 * i + 2] = vec4(m.x.z, m.y.z, m.z.z, m.w.z);
+    }
+}
+
+// Weighted sum of one vertex's dual quaternions, with the same hemisphere
+// test as DualQuaternion::Blend.  Not normalized.
+inline void BlendPalette(const vec4* palette, const ubvec4& bones, const vec4& weights,
+                         Simd::float4& real, Simd::float4& dual) {
+    
+    using namespace Simd;
+    const uint8_t* b = &bones.x;
+    const float* w = &weights.x;
+    const float* q0 = &palette[2 * b[0]].x;
+    real = Mul(Splat(w[0]), Load(q0));
+    dual = Mul(Splat(w[0]), Load(q0 + 4));
+    for (int k = 1; k < 4; ++k) {
+        
+        const float* q = &palette[2 * b[k]].x;
+        float s = q[0] * q0[0] + q[1] * q0[1] + q[2] * q0[2] + q[3] * q0[3] < 0 ? -w[k] : w[k];
+        real = MulAdd(Splat(s), Load(q), real);
+        dual = MulAdd(Splat(s), Load(q + 4), dual);
+    }
+}
+
+// v + 2 r.xyz x (r.xyz x v + r.w v) lane by lane, with r (x, y, z, w
+// streams) unit length and v as x, y, z streams.
+inline void Rotate4(const Simd::float4* r, Simd::float4* v) {
+    
+    using namespace Simd;
+    float4 a0 = MulAdd(r[3], v[0], Sub(Mul(r[1], v[2]), Mul(r[2], v[1])));
+    float4 a1 = MulAdd(r[3], v[1], Sub(Mul(r[2], v[0]), Mul(r[0], v[2])));
+    float4 a2 = MulAdd(r[3], v[2], Sub(Mul(r[0], v[1]), Mul(r[1], v[0])));
+    float4 two = Splat(2);
+    v[0] = MulAdd(two, Sub(Mul(r[1], a2), Mul(r[2], a1)), v[0]);
+    v[1] = MulAdd(two, Sub(Mul(r[2], a0), Mul(r[0], a2)), v[1]);
+    v[2] = MulAdd(two, Sub(Mul(r[0], a1), Mul(r[1], a0)), v[2]);
+}
+
+// Four vertices per iteration: each vertex's influences are summed as whole
+// quaternions, then transposed so that normalizing and applying the blend
+// runs one vertex per lane.  A short tail repeats its first vertex.
+inline void SkinDualQuaternions(const vec4* palette, const ubvec4* bones, const vec4* weights,
+                                const vec3* positions, const vec3* normals,
+                                vec3* outPositions, vec3* outNormals, size_t count) {
+    
+    using namespace Simd;
+    float4 r[4], d[4], v[3];
+    float lanes[6][4];
+    
+    for (size_t i = 0; i < count; i += 4) {
+        
+        size_t used = count - i < 4 ? count - i : 4;
+        for (size_t j = 0; j < 4; ++j) {
+            
+            size_t k = i + (j < used ? j : 0);
+            BlendPalette(palette, bones[k], weights[k], r[j], d[j]);
+            lanes[0][j] = positions[k].x;
+            lanes[1][j] = positions[k].y;
+            lanes[2][j] = positions[k].z;
+            if (normals) {
+                
+                lanes[3][j] = normals[k].x;
+                lanes[4][j] = normals[k].y;
+                lanes[5][j] = normals[k].z;
+            }
+        }
+        Transpose(r[0], r[1], r[2], r[3]);
+        Transpose(d[0], d[1], d[2], d[3]);
+        
+        float4 s = Mul(r[0], r[0]);
+        s = MulAdd(r[1], r[1], s);
+        s = MulAdd(r[2], r[2], s);
+        s = Rsqrt(MulAdd(r[3], r[3], s));
+        for (int c = 0; c < 4; ++c) {
+            
+            r[c] = Mul(r[c], s);
+            d[c] = Mul(d[c], s);
+        }
+        
+        // 2 (r.w d.xyz - d.w r.xyz + r.xyz x d.xyz), as in Translation().
+        float4 two = Splat(2);
+        float4 t[3];
+        for (int c = 0; c < 3; ++c) {
+            
+            int c1 = (c + 1) % 3, c2 = (c + 2) % 3;
+            t[c] = Sub(Mul(r[3], d[c]), Mul(d[3], r[c]));
+            t[c] = Mul(two, Add(t[c], Sub(Mul(r[c1], d[c2]), Mul(r[c2], d[c1]))));
+            v[c] = Load(lanes[c]);
+        }
+        Rotate4(r, v);
+        for (int c = 0; c < 3; ++c) {
+            Store(lanes[c], Add(v[c], t[c]));
+        }
+        for (size_t j = 0; j < used; ++j) {
+            outPositions[i + j] = vec3(lanes[0][j], lanes[1][j], lanes[2][j]);
+        }
+        
+        if (!normals)
+            continue;
+        
+        for (int c = 0; c < 3; ++c) {
+            v[c] = Load(lanes[3 + c]);
+        }
+        Rotate4(r, v);
+        for (int c = 0; c < 3; ++c) {
+            Store(lanes[3 + c], v[c]);
+        }
+        for (size_t j = 0; j < used; ++j) {
+            outNormals[i + j] = vec3(lanes[3][j], lanes[4][j], lanes[5][j]);
+        }
+    }
+}
+
+// One vertex per iteration: the weighted sum of the palette rows is
+// transposed into columns and applied with CombinePoint.
+inline void SkinMatrices(const vec4* palette, const ubvec4* bones, const vec4* weights,
+                         const vec3* positions, const vec3* normals,
+                         vec3* outPositions, vec3* outNormals, size_t count) {
+    
+    using namespace Simd;
+    float4 zero = Splat(0);
+    float result[4];
+    
+    for (size_t i = 0; i < count; ++i) {
+        
+        const uint8_t* b = &bones[i].x;
+        const float* w = &weights[i].x;
+        float4 m[4];
+        for (int k = 0; k < 3; ++k) {
+            m[k] = Mul(Splat(w[0]), Load(&palette[3 * b[0] + k].x));
+        }
+        for (int j = 1; j < 4; ++j) {
+            
+            float4 s = Splat(w[j]);
+            for (int k = 0; k < 3; ++k) {
+                m[k] = MulAdd(s, Load(&palette[3 * b[j] + k].x), m[k]);
+            }
+        }
+        m[3] = zero;
+        Transpose(m[0], m[1], m[2], m[3]);
+        
+        Store(result, CombinePoint(&positions[i].x, m[0], m[1], m[2], m[3]));
+        outPositions[i] = vec3(result[0], result[1], result[2]);
+        if (normals) {
+            
+            Store(result, CombinePoint(&normals[i].x, m[0], m[1], m[2], zero));
+            outNormals[i] = vec3(result[0], result[1], result[2]);
+        }
+    }
+}
+
+// Skins count vertices against a palette packed by PackPalette for the same
+// method.  normals and outNormals may both be null.  Outputs may alias the
+// inputs.  Matrix-skinned normals come out unnormalized, as in the shader.
+inline void SkinVertices(Skinning method, const vec4* palette,
+                         const ubvec4* bones, const vec4* weights,
+                         const vec3* positions, const vec3* normals,
+                         vec3* outPositions, vec3* outNormals, size_t count) {
+    
+    if (method == SkinningDualQuaternion)
+        SkinDualQuaternions(palette, bones, weights, positions, normals, outPositions, outNormals, count);
+    else
+        SkinMatrices(palette, bones, weights, positions, normals, outPositions, outNormals, count);
+}
@@ -0,0 +1,307 @@
+//
+//  RenderQueue.hpp
+//  TouchCone
+//
+//  Created by zhangdl on 3/6/14.
+//  Copyright (c) 2014 com.*. All rights reserved.
+//
+
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <stdint.h>
+#include <vector>
+#include "BufferManager.hpp"
+#include "GLES2.hpp"
+#include "GLState.hpp"
+#include "IndexBuffer.hpp"
+#include "Program.hpp"
+#include "ThreadPool.hpp"
+#include "VertexAttribute.hpp"
+
+const int MaxPacketAttributes = 4;
+const int MaxPacketUniforms = 2;
+
+enum BlendMode {
+    
+    BlendNone,
+    BlendAlpha,
+    BlendAdditive,
+};
+
+// One vertex attribute of a draw: an array, laid out by format from the
+// packet's first vertex, or a constant value for every vertex.
+struct PacketAttribute {
+    
+    GLint slot;
+    bool array;
+    MeshAttribute format;
+    vec4 value;
+};
+
+// A float uniform of up to 16 components, such as a mat4.
+struct PacketUniform {
+    
+    int uniform;
+    GLfloat values[16];
+};
+
+// Everything one glDrawElements call needs, so it can be drawn later and in
+// any order.  depth is the draw's distance from the eye; vertexOffset is where
+// its first vertex starts in the vertices range.
+struct DrawPacket {
+    
+    const Program* program;
+    BufferHandle vertices;
+    GLintptr vertexOffset;
+    GLsizei stride;
+    BufferHandle indices;
+    IndexType type;
+    GLsizei count;
+    PacketAttribute attributes[MaxPacketAttributes];
+    int attributeCount;
+    PacketUniform uniforms[MaxPacketUniforms];
+    int uniformCount;
+    bool depthTest;
+    bool depthWrite;
+    BlendMode blend;
+    float depth;
+};
+
+// A packet's 64-bit sort key.  From the most significant bit down:
+//
+//     opaque        0 | state 4 | program 8 | vertex block 12 | depth 24 | index block 12
+//     translucent   1 | far-to-near depth 24 | state 4 | program 8 | vertex block 12 | index block 12
+//
+// so opaque draws are grouped by state, program and vertex buffer and drawn
+// front to back within each group, for early depth rejection, and blended
+// draws come after them, back to front.  Program handles and block numbers
+// wrap past their widths, which only costs some grouping.  Only reads, so
+// any thread may make keys while no buffers are being uploaded.
+inline uint64_t MakeSortKey(const BufferManager& buffers, const DrawPacket& packet) {
+    
+    // A non-negative float's bits sort like the float, so the top 24 of the
+    // 31 below the sign are a depth quantized relative to its own magnitude.
+    uint32_t depth = 0;
+    if (packet.depth > 0) {
+        
+        std::memcpy(&depth, &packet.depth, sizeof(depth));
+        depth >>= 7;
+    }
+    
+    uint64_t state = (packet.depthTest ? 8 : 0) | (packet.depthWrite ? 4 : 0) | packet.blend;
+    uint64_t program = packet.program->GetHandle() & 0xFF;
+    uint64_t vertexBlock = buffers.GetBlock(packet.vertices) & 0xFFF;
+    uint64_t indexBlock = buffers.GetBlock(packet.indices) & 0xFFF;
+    if (packet.blend == BlendNone)
+        return state << 59 | program << 51 | vertexBlock << 39 | (uint64_t) depth << 12 | indexBlock;
+    return 1ull << 63 | (uint64_t) (~depth & 0xFFFFFF) << 39 | state << 35 | program << 27 |
+           vertexBlock << 12 | indexBlock;
+}
+
+// Packets recorded by one thread, each with its key already made.
+class CommandList {
+
+public:
+    explicit CommandList(const BufferManager& buffers) : m_buffers(&buffers) {}
+    void Clear();
+    void Submit(const DrawPacket& packet);
+    void Swap(CommandList& other);
+    size_t GetPacketCount() const { return m_packets.size(); }
+    const DrawPacket& GetPacket(size_t i) const { return m_packets[i]; }
+    uint64_t GetKey(size_t i) const { return m_keys[i]; }
+
+private:
+    const BufferManager* m_buffers;
+    std::vector<DrawPacket> m_packets;
+    std::vector<uint64_t> m_keys;
+};
+
+inline void CommandList::Clear() {
+    
+    m_packets.clear();
+    m_keys.clear();
+}
+
+inline void CommandList::Submit(const DrawPacket& packet) {
+    
+    m_keys.push_back(MakeSortKey(*m_buffers, packet));
+    m_packets.push_back(packet);
+}
+
+inline void CommandList::Swap(CommandList& other) {
+    
+    std::swap(m_buffers, other.m_buffers);
+    m_packets.swap(other.m_packets);
+    m_keys.swap(other.m_keys);
+}
+
+// A frame's draws, recorded as packets into command lists, then merged,
+// sorted by key and only then turned into GL calls on the thread that owns
+// the context.  Packets submitted directly go in a list of the queue's own;
+// Record() fills more lists in parallel.  Lists are merged in the order they
+// were filled and the sort is stable, so the draw order is the same however
+// many threads recorded it, and packets with equal keys keep the order they
+// were submitted in.
+class RenderQueue {
+
+public:
+    explicit RenderQueue(const BufferManager& buffers);
+    void Clear();
+    void Submit(const DrawPacket& packet) { m_lists[0].Submit(packet); }
+    
+    // Calls record(begin, end, list) for consecutive chunks of [0, count),
+    // each at most grain objects long, on the pool's threads.  Each chunk has
+    // a list of its own, so record can cull, compute uniforms and submit
+    // without locking, but mustn't make GL calls.
+    void Record(ThreadPool& pool, int count, int grain,
+                const std::function<void(int, int, CommandList&)>& record);
+    
+    // Merges the lists and sorts their packets.
+    void Sort();
+    
+    // Draws the packets in sorted order, setting state through state.
+    void Execute(GLState& state) const;
+    
+    // The packets and their keys in sorted order, once Sort() has run.
+    size_t GetPacketCount() const { return m_entries.size(); }
+    const DrawPacket& GetPacket(size_t i) const { return *m_entries[i].packet; }
+    uint64_t GetKey(size_t i) const { return m_entries[i].key; }
+
+private:
+    RenderQueue(const RenderQueue&);
+    RenderQueue& operator = (const RenderQueue&);
+    
+    struct Entry {
+        
+        uint64_t key;
+        const DrawPacket* packet;
+    };
+    
+    const BufferManager& m_buffers;
+    
+    // Kept between frames so their storage is reused; m_listCount are in use.
+    std::vector<CommandList> m_lists;
+    size_t m_listCount;
+    std::vector<Entry> m_entries;
+    std::vector<Entry> m_scratch;
+};
+
+inline RenderQueue::RenderQueue(const BufferManager& buffers) : m_buffers(buffers), m_listCount(1) {
+    
+    m_lists.push_back(CommandList(buffers));
+}
+
+inline void RenderQueue::Clear() {
+    
+    m_lists[0].Clear();
+    m_listCount = 1;
+    m_entries.clear();
+}
+
+inline void RenderQueue::Record(ThreadPool& pool, int count, int grain,
+                                const std::function<void(int, int, CommandList&)>& record) {
+    
+    grain = std::max(grain, 1);
+    size_t first = m_listCount;
+    m_listCount += count > 0 ? (count + grain - 1) / grain : 0;
+    while (m_lists.size() < m_listCount)
+        m_lists.push_back(CommandList(m_buffers));
+    
+    // Each chunk records into a list on its own thread's stack, so threads
+    // don't write next to each other, and swaps it into place once done.
+    pool.ParallelFor(count, grain, [&](int begin, int end) {
+        
+        CommandList list(m_buffers);
+        list.Swap(m_lists[first + begin / grain]);
+        list.Clear();
+        record(begin, end, list);
+        list.Swap(m_lists[first + begin / grain]);
+    });
+}
+
+// Least significant digit first radix sort, a byte at a time.  A byte that
+// every key shares is skipped, which is most of them for a small queue.
+inline void RenderQueue::Sort() {
+    
+    m_entries.clear();
+    for (size_t l = 0; l < m_listCount; ++l) {
+        
+        const CommandList& list = m_lists[l];
+        for (size_t i = 0; i < list.GetPacketCount(); ++i) {
+            
+            Entry entry = { list.GetKey(i), &list.GetPacket(i) };
+            m_entries.push_back(entry);
+        }
+    }
+    
+    m_scratch.resize(m_entries.size());
+    for (int shift = 0; shift < 64; shift += 8) {
+        
+        size_t offsets[256] = {};
+        for (size_t i = 0; i < m_entries.size(); ++i) {
+            ++offsets[m_entries[i].key >> shift & 0xFF];
+        }
+        if (m_entries.empty() || offsets[m_entries[0].key >> shift & 0xFF] == m_entries.size())
+            continue;
+        
+        size_t total = 0;
+        for (int digit = 0; digit < 256; ++digit) {
+            
+            size_t count = offsets[digit];
+            offsets[digit] = total;
+            total += count;
+        }
+        for (size_t i = 0; i < m_entries.size(); ++i) {
+            m_scratch[offsets[m_entries[i].key >> shift & 0xFF]++] = m_entries[i];
+        }
+        m_entries.swap(m_scratch);
+    }
+}
+
+inline void RenderQueue::Execute(GLState& state) const {
+    
+    for (size_t i = 0; i < m_entries.size(); ++i) {
+        
+        const DrawPacket& packet = *m_entries[i].packet;
+        state.UseProgram(packet.program->GetHandle());
+        for (int u = 0; u < packet.uniformCount; ++u) {
+            packet.program->SetUniform(packet.uniforms[u].uniform, packet.uniforms[u].values);
+        }
+        
+        if (packet.depthTest)
+            state.Enable(GL_DEPTH_TEST);
+        else
+            state.Disable(GL_DEPTH_TEST);
+        state.DepthMask(packet.depthWrite);
+        if (packet.blend == BlendNone) {
+            
+            state.Disable(GL_BLEND);
+        } else {
+            
+            state.Enable(GL_BLEND);
+            state.BlendFunc(packet.blend == BlendAlpha ? GL_SRC_ALPHA : GL_ONE,
+                            packet.blend == BlendAlpha ? GL_ONE_MINUS_SRC_ALPHA : GL_ONE);
+        }
+        
+        const char* first = (const char*) m_buffers.Bind(packet.vertices) + packet.vertexOffset;
+        for (int a = 0; a < packet.attributeCount; ++a) {
+            
+            const PacketAttribute& attribute = packet.attributes[a];
+            if (attribute.slot < 0)
+                continue;
+            if (attribute.array) {
+                
+                state.EnableVertexAttribArray(attribute.slot);
+                VertexAttribPointer(state, attribute.slot, attribute.format, packet.stride, first);
+            } else {
+                
+                state.DisableVertexAttribArray(attribute.slot);
+                glVertexAttrib4fv(attribute.slot, attribute.value.Pointer());
+            }
+        }
+        glDrawElements(GL_TRIANGLES, packet.count, packet.type, m_buffers.Bind(packet.indices));
+    }
+}
@@ -6,10 +6,12 @@
 //  Copyright (c) 2014 com.*. All rights reserved.
 //
 
+#include <cassert>
 #include <iostream>
-#include <OpenGLES/ES1/gl.h>
-#include <OpenGLES/ES1/glext.h>
 #include <vector>
+#include "GLES1.hpp"
+#include "GLState1.hpp"
+#include "IndexBuffer.hpp"
 #include "IRenderingEngine.hpp"
 #include "Quaternion.hpp"
 
@@ -36,24 +38,27 @@ public:
     RenderingEngine1();
     void Initialize(int width, int height);
     void Render() const;
-    void UpdateAnimation(float timeStep);
-    void OnRotate(DeviceOrientation newOrientation);
-    void OnFingerUp(ivec2 location);
-    void OnFingerDown(ivec2 location);
-    void OnFingerMove(ivec2 oldLocation, ivec2 newLocation);
+    bool UpdateAnimation(float timeStep);
+    bool OnRotate(DeviceOrientation newOrientation);
+    bool OnFingerUp(ivec2 location);
+    bool OnFingerDown(ivec2 location);
+    bool OnFingerMove(ivec2 oldLocation, ivec2 newLocation);
+    RenderingStats GetStats() const;
 private:
+    void Draw(const IndexBuffer& indices, bool colors) const;
+    
     Animation m_animation;
     
     vector<Vertex> m_coneVertices;
-    vector<GLubyte> m_coneIndices;
+    IndexBuffer m_bodyIndices;
+    IndexBuffer m_diskIndices;
+    mutable GLState1 m_state;
     
     GLfloat m_rotationAngle;
     GLfloat m_scale;
     
-    GLuint m_bodyIndexCount;
     GLuint m_colorRenderbuffer;
     GLuint m_depthRenderbuffer;
-    GLuint m_diskIndexCount;
     GLuint m_framebuffer;
     
     ivec2 m_pivotPoint;
@@ -77,17 +82,20 @@ void RenderingEngine1::Initialize(int width, int height) {
     const float coneRadius = 0.5f;
     const float coneHeight = 1.866f;
     const int coneSlices = 40;
-    const float dtheta = TwoPi / coneSlices;
     const int vertexCount = coneSlices * 2 + 1;
     
     m_coneVertices.resize(vertexCount);
     vector<Vertex>::iterator vertex = m_coneVertices.begin();
     
+    // Every slice angle in one pass, each computed from its index
+    vector<float> sines(coneSlices), cosines(coneSlices);
+    SinCosSteps(coneSlices, &sines[0], &cosines[0], coneSlices);
+    
     // Cone's body
-    for (float theta = 0; vertex != m_coneVertices.end() - 1; theta += dtheta) {
+    for (int slice = 0; slice < coneSlices; ++slice) {
         
         // Grayscale gradient
-        float brightness = abs(sin(theta));
+        float brightness = abs(sines[slice]);
         vec4 color(brightness, brightness, brightness, 1);
         
         //Apex vertex
@@ -96,9 +104,9 @@ void RenderingEngine1::Initialize(int width, int height) {
         vertex++;
         
         //Rim vertex
-        vertex->Position.x = coneRadius * cos(theta);
+        vertex->Position.x = coneRadius * cosines[slice];
         vertex->Position.y = 1 - coneHeight;
-        vertex->Position.z = coneRadius * sin(theta);
+        vertex->Position.z = coneRadius * sines[slice];
         vertex->Color = color;
         vertex++;
     }
@@ -107,11 +115,11 @@ void RenderingEngine1::Initialize(int width, int height) {
     vertex->Position = vec3(0, 1 - coneHeight, 0);
     vertex->Color = vec4(1, 1, 1, 1);
     
-    m_bodyIndexCount = coneSlices * 3;
-    m_diskIndexCount = coneSlices * 3;
+    const int bodyIndexCount = coneSlices * 3;
+    const int diskIndexCount = coneSlices * 3;
     
-    m_coneIndices.resize(m_bodyIndexCount + m_diskIndexCount);
-    vector<GLubyte>::iterator index = m_coneIndices.begin();
+    vector<unsigned> indices(bodyIndexCount + diskIndexCount);
+    vector<unsigned>::iterator index = indices.begin();
     
     // Body triangles
     for (int i = 0; i < coneSlices * 2; i += 2) {
@@ -129,6 +137,13 @@ void RenderingEngine1::Initialize(int width, int height) {
         *index++ = (i + 2) % (2 * coneSlices);
     }
     
+    // Narrowest index type that fits, split up if 32-bit indices are missing
+    bool hasUintIndices = HasExtension(glGetString(GL_EXTENSIONS), "GL_OES_element_index_uint");
+    bool fits = m_bodyIndices.Assign(&indices[0], bodyIndexCount, hasUintIndices);
+    fits = m_diskIndices.Assign(&indices[bodyIndexCount], diskIndexCount, hasUintIndices) && fits;
+    assert(fits && "a cone triangle spans more than 16-bit indices reach");
+    (void) fits;
+    
     //Create the depth buffer
     glGenRenderbuffersOES(1, &m_depthRenderbuffer);
     glBindRenderbufferOES(GL_RENDERBUFFER_OES, m_depthRenderbuffer);
@@ -162,68 +177,90 @@ void RenderingEngine1::Initialize(int width, int height) {
     glTranslatef(0, 0, -7);
 }
 
+// The vertex array stays enabled from one frame to the next; nothing is
+// drawn without it.
 void RenderingEngine1::Render() const {
     
-    GLsizei stride = sizeof(Vertex);
-    const GLvoid* pCoords = &m_coneVertices[0].Position.x;
-    const GLvoid* pColors = &m_coneVertices[0].Color.x;
-    
-    glClearColor(0.5f, 0.5f, 0.5f, 1);
+    m_state.ClearColor(0.5f, 0.5f, 0.5f, 1);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
     
     glPushMatrix();
     glRotatef(m_rotationAngle, 0, 0, 1);
     glScalef(m_scale, m_scale, m_scale);
     
-    glVertexPointer(3, GL_FLOAT, stride, pCoords);
-    glColorPointer(4, GL_FLOAT, stride, pColors);
-    
-    glEnableClientState(GL_VERTEX_ARRAY);
-    
-    const GLvoid* bodyIndices = &m_coneIndices[0];
-    const GLvoid* diskIndices = &m_coneIndices[m_bodyIndexCount];
-    
-    glEnableClientState(GL_COLOR_ARRAY);
-    glDrawElements(GL_TRIANGLES, m_bodyIndexCount, GL_UNSIGNED_BYTE, bodyIndices);
-    glDisableClientState(GL_COLOR_ARRAY);
+    m_state.EnableClientState(GL_VERTEX_ARRAY);
+    m_state.EnableClientState(GL_COLOR_ARRAY);
+    Draw(m_bodyIndices, true);
+    m_state.DisableClientState(GL_COLOR_ARRAY);
     glColor4f(1, 1, 1, 1);
-    glDrawElements(GL_TRIANGLES, m_diskIndexCount, GL_UNSIGNED_BYTE, diskIndices);
+    Draw(m_diskIndices, false);
     
-    glDisableClientState(GL_VERTEX_ARRAY);
     glPopMatrix();
+    m_state.EndFrame();
 }
 
-void RenderingEngine1::OnFingerUp(ivec2 location) {
+RenderingStats RenderingEngine1::GetStats() const {
+    
+    RenderingStats stats = {};
+    stats.MeshVertexCount = m_coneVertices.size();
+    stats.StateCallCount = m_state.GetFrameCallCount();
+    stats.StateFilteredCount = m_state.GetFrameFilteredCount();
+    return stats;
+}
 
+// One draw call per index batch, with the arrays moved to its base vertex.
+// The color array is only pointed at the vertices when it's used.
+void RenderingEngine1::Draw(const IndexBuffer& indices, bool colors) const {
+    
+    GLsizei stride = sizeof(Vertex);
+    for (size_t i = 0; i < indices.GetBatchCount(); ++i) {
+        
+        IndexBatch batch = indices.GetBatch(i);
+        const Vertex& first = m_coneVertices[batch.baseVertex];
+        m_state.VertexPointer(3, GL_FLOAT, stride, &first.Position.x);
+        if (colors)
+            m_state.ColorPointer(4, GL_FLOAT, stride, &first.Color.x);
+        glDrawElements(GL_TRIANGLES, batch.count, batch.type, batch.indices);
+    }
+}
+
+bool RenderingEngine1::OnFingerUp(ivec2 location) {
+
+    bool changed = m_scale != 1.0f;
     m_scale = 1.0f;
+    return changed;
 }
 
-void RenderingEngine1::OnFingerDown(ivec2 location) {
+bool RenderingEngine1::OnFingerDown(ivec2 location) {
 
+    bool changed = m_scale != 1.5f;
     m_scale = 1.5f;
-    OnFingerMove(location, location);
+    return OnFingerMove(location, location) || changed;
 }
 
-void RenderingEngine1::OnFingerMove(ivec2 previous, ivec2 location) {
+bool RenderingEngine1::OnFingerMove(ivec2 previous, ivec2 location) {
 
     vec2 direction = vec2(location - m_pivotPoint).Normalized();
     
     //Flip the y-axis because pixel coords increase toward the bottom.
     direction.y = -direction.y;
     
-    m_rotationAngle = std::acos(direction.y) * 180.0f / 3.14159f;
+    float angle = std::acos(direction.y) * 180.0f / 3.14159f;
     if (direction.x > 0) {
-        m_rotationAngle = -m_rotationAngle;
+        angle = -angle;
     }
+    bool changed = angle != m_rotationAngle;
+    m_rotationAngle = angle;
+    return changed;
 }
 
-void RenderingEngine1::OnRotate(DeviceOrientation orientation) {
-    
+bool RenderingEngine1::OnRotate(DeviceOrientation orientation) {
     
+    return false;
 }
 
-void RenderingEngine1::UpdateAnimation(float timeStep) {
-    
+bool RenderingEngine1::UpdateAnimation(float timeStep) {
     
+    return false;
 }
 
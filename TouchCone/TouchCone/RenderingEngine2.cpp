@@ -8,13 +8,27 @@
 
 #include "IRenderingEngine.hpp"
 
+#include <algorithm>
+#include <cassert>
 #include <cmath>
+#include <cstddef>
+#include <cstring>
 #include <iostream>
-#include <OpenGLES/ES2/gl.h>
-#include <OpenGLES/ES2/glext.h>
+#include <string>
 #include <vector>
 #include "Quaternion.hpp"
 #include "IRenderingEngine.hpp"
+#include "BufferManager.hpp"
+#include "GLES2.hpp"
+#include "GLState.hpp"
+#include "IndexBuffer.hpp"
+#include "LevelOfDetail.hpp"
+#include "MeshFile.hpp"
+#include "MeshOptimizer.hpp"
+#include "ParametricSurface.hpp"
+#include "Program.hpp"
+#include "RenderQueue.hpp"
+#include "VertexAttribute.hpp"
 
 #define STRINGIFY(A) #A
 #include "../Shaders/Simple.vert"
@@ -24,12 +38,44 @@ using namespace std;
 
 static const float AnimationDuration = 0.25f;
 
+// Fixed transforms, built at compile time.
+static constexpr mat4 ProjectionMatrix = mat4::Frustum(-1.6f, 1.6f, -2.4f, 2.4f, 5, 10);
+static constexpr affine3 ViewTranslation = affine3::Translate(0, 0, -7);
+
 struct Vertex {
     
     vec3 Position;
     vec4 Color;
 };
 
+// What actually gets drawn when half floats are available: 12 bytes a vertex
+// instead of 28.  w is stored so the position stays 4-byte aligned.
+struct PackedVertex {
+    
+    hvec4 Position;
+    ubvec4 Color;
+};
+
+// One glDrawElements call once everything is in buffer objects.
+// vertexOffset is where the batch's base vertex starts in the vertex buffer.
+struct DrawBatch {
+    
+    IndexType type;
+    GLsizei count;
+    BufferHandle indices;
+    GLintptr vertexOffset;
+};
+
+// One tessellation of the cone, indexing into the shared vertex buffer.  The
+// index buffers are only kept until they're uploaded.
+struct ConeLevel {
+    
+    IndexBuffer Body;
+    IndexBuffer Disk;
+    vector<DrawBatch> BodyBatches;
+    vector<DrawBatch> DiskBatches;
+};
+
 struct Animation {
     
     Quaternion Start;
@@ -42,43 +88,72 @@ struct Animation {
 class RenderingEngine2 : public IRenderingEngine {
     
 public:
-    RenderingEngine2();
+    RenderingEngine2(const char* cacheDirectory);
     void Initialize(int width, int height);
     void Render() const;
-    void UpdateAnimation(float timeStep);
-    void OnRotate(DeviceOrientation newOrientation);
-    void OnFingerUp(ivec2 location);
-    void OnFingerDown(ivec2 location);
-    void OnFingerMove(ivec2 oldLocation, ivec2 newLocation);
+    bool UpdateAnimation(float timeStep);
+    bool OnRotate(DeviceOrientation newOrientation);
+    bool OnFingerUp(ivec2 location);
+    bool OnFingerDown(ivec2 location);
+    bool OnFingerMove(ivec2 oldLocation, ivec2 newLocation);
+    RenderingStats GetStats() const;
     
 private:
     GLuint BuildShader(const char* source, GLenum shaderType) const;
     GLuint BuildProgram(const char* vShader, const char* fShader) const;
+    void BuildCone(const int* coneSlices, int levelCount, float coneRadius, float coneHeight,
+                   bool hasUintIndices, bool hasHalfFloats);
+    mat4 GetModelView() const;
+    void Upload(const IndexBuffer& indices, vector<DrawBatch>& batches);
+    void RecordCone(CommandList& list) const;
+    void Submit(CommandList& list, const vector<DrawBatch>& batches, const DrawPacket& packet) const;
     
     Animation m_animation;
     
+    // The vertices come from m_vertices, which points into one of the
+    // vectors or into the mapped mesh cache, and are drawn from
+    // m_vertexBuffer once uploaded.
     vector<Vertex> m_coneVertices;
-    vector<GLubyte> m_coneIndices;
+    vector<PackedVertex> m_packedVertices;
+    MappedMesh m_cachedCone;
+    string m_cacheDirectory;
+    const unsigned char* m_vertices;
+    GLsizei m_vertexStride;
+    MeshAttribute m_positionAttribute;
+    MeshAttribute m_colorAttribute;
+    mutable GLState m_state;
+    BufferManager m_buffers;
+    mutable RenderQueue m_queue;
+    mutable ThreadPool m_pool;
+    BufferHandle m_vertexBuffer;
+    vector<ConeLevel> m_levels;
+    LevelOfDetail m_lod;
+    float m_viewportHeight;
+    RenderingStats m_stats;
 
     GLfloat m_rotationAngle;
     GLfloat m_scale;
     
     ivec2 m_pivotPoint;
     
-    GLuint m_bodyIndexCount;
     GLuint m_colorRenderbuffer;
     GLuint m_depthRenderbuffer;
-    GLuint m_diskIndexCount;
     GLuint m_framebuffer;
-    GLuint m_simpleProgram;
+    Program m_simpleProgram;
+    GLint m_positionSlot;
+    GLint m_colorSlot;
+    int m_modelviewUniform;
 };
 
-IRenderingEngine* CreateRenderEngine2() {
+IRenderingEngine* CreateRenderEngine2(const char* cacheDirectory) {
     
-    return new RenderingEngine2();
+    return new RenderingEngine2(cacheDirectory);
 }
 
-RenderingEngine2::RenderingEngine2() : m_rotationAngle(0), m_scale(1) {
+RenderingEngine2::RenderingEngine2(const char* cacheDirectory)
+    : m_cacheDirectory(cacheDirectory ? cacheDirectory : ""), m_vertices(0), m_vertexStride(0),
+      m_buffers(m_state), m_queue(m_buffers), m_vertexBuffer(0), m_viewportHeight(0), m_stats(),
+      m_rotationAngle(0), m_scale(1), m_positionSlot(-1), m_colorSlot(-1), m_modelviewUniform(-1) {
     
     //Create & bind the color buffer so that the caller can allocate its space.
     glGenRenderbuffers(1, &m_colorRenderbuffer);
@@ -91,57 +166,90 @@ void RenderingEngine2::Initialize(int width, int height) {
     
     const float coneRadius = 0.5f;
     const float coneHeight = 1.866f;
-    const int coneSlices = 40;
-    const float dtheta = TwoPi / coneSlices;
-    const int vertexCount = coneSlices * 2 + 1;
-
-    m_coneVertices.resize(vertexCount);
-    vector<Vertex>::iterator vertex = m_coneVertices.begin();
+    const int coneSlices[] = { 40, 20, 10, 5 };
+    const int levelCount = sizeof(coneSlices) / sizeof(coneSlices[0]);
     
-    // Cone body
-    for (float theta = 0; vertex != m_coneVertices.end() - 1; theta += dtheta) {
+    for (int level = 0; level < levelCount; ++level) {
+        m_lod.AddLevel(ChordError(coneRadius, coneSlices[level]));
+    }
+    m_levels.resize(levelCount);
+    m_viewportHeight = height;
+    
+    // The finished cone is cached on disk, keyed by everything it's built from
+    bool hasUintIndices = HasExtension(glGetString(GL_EXTENSIONS), "GL_OES_element_index_uint");
+    bool hasHalfFloats = HasHalfFloatVertices();
+    uint64_t key = HashBytes(&MeshGeneratorVersion, sizeof(MeshGeneratorVersion));
+    key = HashBytes(&coneRadius, sizeof(coneRadius), key);
+    key = HashBytes(&coneHeight, sizeof(coneHeight), key);
+    key = HashBytes(coneSlices, sizeof(coneSlices), key);
+    key = HashBytes(&hasUintIndices, sizeof(hasUintIndices), key);
+    key = HashBytes(&hasHalfFloats, sizeof(hasHalfFloats), key);
+    string cachePath = m_cacheDirectory + "/Cone.mesh";
+    
+    // A file whose key matches but whose layout isn't the one drawn below is
+    // rebuilt rather than trusted
+    uint32_t vertexStride = hasHalfFloats ? sizeof(PackedVertex) : sizeof(Vertex);
+    if (!m_cacheDirectory.empty() && m_cachedCone.Open(cachePath.c_str(), key)) {
         
-        float brightness = abs(sin(theta));
-        vec4 color(brightness, brightness, brightness, 1);
+        const MeshFileHeader& header = m_cachedCone.GetHeader();
+        if (header.GroupCount != 2u * levelCount || header.VertexStride != vertexStride ||
+            header.AttributeCount != 2)
+            m_cachedCone.Close();
+    }
+    
+    if (!m_cachedCone.IsOpen()) {
         
-        vertex->Position = vec3(0, 1, 0);
-        vertex->Color = color;
-        vertex++;
+        BuildCone(coneSlices, levelCount, coneRadius, coneHeight, hasUintIndices, hasHalfFloats);
         
-        vertex->Position.x = coneRadius * cos(theta);
-        vertex->Position.y = 1 - coneHeight;
-        vertex->Position.z = coneRadius * sin(theta);
-        vertex->Color = color;
-        vertex++;
+        vector<IndexBuffer> groups;
+        for (int level = 0; level < levelCount; ++level) {
+            
+            groups.push_back(m_levels[level].Body);
+            groups.push_back(m_levels[level].Disk);
+        }
+        size_t vertexCount = hasHalfFloats ? m_packedVertices.size() : m_coneVertices.size();
+        MeshAttribute attributes[] = { m_positionAttribute, m_colorAttribute };
+        if (!m_cacheDirectory.empty() &&
+            WriteMeshFile(cachePath.c_str(), key, m_vertices, vertexCount, m_vertexStride,
+                          attributes, 2, &groups[0], groups.size()))
+            m_cachedCone.Open(cachePath.c_str(), key);
     }
     
-    // Cone disk center
-    vertex->Position = vec3(0, 1- coneHeight, 0);
-    vertex->Color = vec4(1, 1, 1, 1);
-    
-    // Indices
-    m_bodyIndexCount = coneSlices * 3;
-    m_diskIndexCount = coneSlices * 3;
-    
-    m_coneIndices.resize(m_bodyIndexCount + m_diskIndexCount);
-    vector<GLubyte>::iterator index = m_coneIndices.begin();
-    
-    // Body index
-    for (int i = 0; i < coneSlices * 2; i += 2) {
+    // Draw straight from the mapped file when there is one
+    if (m_cachedCone.IsOpen()) {
         
-        *index++ = i;
-        *index++ = (i + 1) % (coneSlices * 2);
-        *index++ = (i + 3) % (coneSlices * 2);
+        const MeshFileHeader& header = m_cachedCone.GetHeader();
+        m_vertices = m_cachedCone.GetVertices();
+        m_vertexStride = header.VertexStride;
+        m_positionAttribute = header.Attributes[0];
+        m_colorAttribute = header.Attributes[1];
+        for (int level = 0; level < levelCount; ++level) {
+            
+            m_cachedCone.GetIndices(2 * level, m_levels[level].Body);
+            m_cachedCone.GetIndices(2 * level + 1, m_levels[level].Disk);
+        }
+        vector<Vertex>().swap(m_coneVertices);
+        vector<PackedVertex>().swap(m_packedVertices);
     }
     
-    // Disk index
-    const int diskCenterIndex = vertexCount - 1;
-    for (int i = 1; i < coneSlices * 2 + 1; i += 2) {
+    // Upload once; from here on nothing is drawn from CPU memory
+    size_t vertexCount = m_cachedCone.IsOpen() ? m_cachedCone.GetHeader().VertexCount
+                       : hasHalfFloats ? m_packedVertices.size() : m_coneVertices.size();
+    m_stats.MeshVertexCount = vertexCount;
+    m_stats.MeshFromCache = m_cachedCone.IsOpen();
+    m_vertexBuffer = m_buffers.Upload(GL_ARRAY_BUFFER, m_vertices, vertexCount * m_vertexStride);
+    for (int level = 0; level < levelCount; ++level) {
         
-        *index++ = diskCenterIndex;
-        *index++ = i;
-        *index++ = (i + 2) % (coneSlices * 2);
+        ConeLevel& cone = m_levels[level];
+        Upload(cone.Body, cone.BodyBatches);
+        Upload(cone.Disk, cone.DiskBatches);
+        cone.Body = IndexBuffer();
+        cone.Disk = IndexBuffer();
     }
+    vector<Vertex>().swap(m_coneVertices);
+    vector<PackedVertex>().swap(m_packedVertices);
+    m_cachedCone.Close();
+    m_vertices = 0;
     
     // Create depth buffer
     glGenRenderbuffers(1, &m_depthRenderbuffer);
@@ -166,83 +274,245 @@ void RenderingEngine2::Initialize(int width, int height) {
     //Bind renderbuffer from rendering
     glBindRenderbuffer(GL_RENDERBUFFER, m_colorRenderbuffer);
     
-    glViewport(0, 0, width, height);
-    glEnable(GL_DEPTH_TEST);
+    m_state.Viewport(0, 0, width, height);
+    m_state.Enable(GL_DEPTH_TEST);
     
-    m_simpleProgram = BuildProgram(SimpleVertexShader, SimpleFragmentShader);
-    glUseProgram(m_simpleProgram);
+    m_simpleProgram.Attach(BuildProgram(SimpleVertexShader, SimpleFragmentShader));
+    m_state.UseProgram(m_simpleProgram.GetHandle());
+    m_positionSlot = m_simpleProgram.GetAttribute(HashName("Position"));
+    m_colorSlot = m_simpleProgram.GetAttribute(HashName("SourceColor"));
+    m_modelviewUniform = m_simpleProgram.GetUniform(HashName("ModelView"));
     
     //Set the projection matrix
-    GLint projectionUniform = glGetUniformLocation(m_simpleProgram, "Projection");
-    
-    mat4 projectionMatrix = mat4::Frustum(-1.6f, 1.6f, -2.4, 2.4, 5, 10);
-    glUniformMatrix4fv(projectionUniform, 1, 0, projectionMatrix.Pointer());
+    m_simpleProgram.SetUniform(m_simpleProgram.GetUniform(HashName("Projection")), ProjectionMatrix);
 }
 
-void RenderingEngine2::Render() const {
-    
-    GLuint positionSlot = glGetAttribLocation(m_simpleProgram, "Position");
-    GLuint colorSlot = glGetAttribLocation(m_simpleProgram, "SourceColor");
+// Generates and optimizes every level of the cone into m_coneVertices, or
+// m_packedVertices when half floats are available, and m_levels.
+void RenderingEngine2::BuildCone(const int* coneSlices, int levelCount, float coneRadius, float coneHeight,
+                                 bool hasUintIndices, bool hasHalfFloats) {
+    
+    // Every level's body and disk, finest first, share one vertex buffer.
+    // Surfaces big enough to be worth it are generated on several threads.
+    vector<Vertex>().swap(m_coneVertices);
+    vector<PackedVertex>().swap(m_packedVertices);
+    vector<unsigned> indices;
+    vector<size_t> groupSizes;
+    for (int level = 0; level < levelCount; ++level) {
+        
+        const int slices = coneSlices[level];
+        Cone cone(coneHeight, coneRadius, slices, 1);
+        Disk disk(coneRadius, slices, 1);
+        const unsigned bodyVertex = m_coneVertices.size();
+        const unsigned diskVertex = bodyVertex + cone.GetVertexCount();
+        const size_t bodyIndex = indices.size();
+        const size_t diskIndex = bodyIndex + cone.GetTriangleIndexCount();
+        m_coneVertices.resize(diskVertex + disk.GetVertexCount());
+        indices.resize(diskIndex + disk.GetTriangleIndexCount());
+        Generate(cone, m_pool, &m_coneVertices[bodyVertex].Position, 0, sizeof(Vertex),
+                 &indices[bodyIndex], bodyVertex);
+        Generate(disk, m_pool, &m_coneVertices[diskVertex].Position, 0, sizeof(Vertex),
+                 &indices[diskIndex], diskVertex);
+        
+        // Cone winds the body to face out, but this cone has always been
+        // wound apex, rim, next rim, which faces in; swap the first two of
+        // each triangle to keep that order.
+        for (size_t i = bodyIndex; i < diskIndex; i += 3) {
+            swap(indices[i], indices[i + 1]);
+        }
+        groupSizes.push_back(cone.GetTriangleIndexCount());
+        groupSizes.push_back(disk.GetTriangleIndexCount());
+        
+        // Grayscale gradient by slice angle; the disk is drawn white. The
+        // generated cone stands on y = 0, so lift it to put the apex at y = 1.
+        vector<float> sines(slices), cosines(slices);
+        SinCosSteps(slices, &sines[0], &cosines[0], slices);
+        for (unsigned i = bodyVertex; i < m_coneVertices.size(); ++i) {
+            
+            Vertex& vertex = m_coneVertices[i];
+            float brightness = i < diskVertex ? abs(sines[(i - bodyVertex) % slices]) : 1;
+            vertex.Color = vec4(brightness, brightness, brightness, 1);
+            vertex.Position.y += 1 - coneHeight;
+        }
+    }
     
-    mat4 rotation = mat4::Rotate(m_rotationAngle);
-    mat4 scale = mat4::Scale(m_scale);
-    mat4 translation = mat4::Translate(0, 0, -7);
+    // Weld, reorder for the vertex cache and overdraw, then for fetches
+    MeshReport report = OptimizeMesh(m_coneVertices, indices, &groupSizes[0], groupSizes.size());
+    m_stats.MeshACMRBefore = report.acmrBefore;
+    m_stats.MeshACMRAfter = report.acmrAfter;
     
-    GLint modelviewUniform = glGetUniformLocation(m_simpleProgram, "ModelView");
-    mat4 modelviewMatrix = scale * rotation * translation;
+    // Narrowest index type that fits, split up if 32-bit indices are missing
+    for (int level = 0, offset = 0; level < levelCount; ++level) {
+        
+        size_t bodyIndexCount = groupSizes[2 * level];
+        size_t diskIndexCount = groupSizes[2 * level + 1];
+        bool fits = m_levels[level].Body.Assign(&indices[offset], bodyIndexCount, hasUintIndices);
+        fits = m_levels[level].Disk.Assign(&indices[offset + bodyIndexCount], diskIndexCount,
+                                           hasUintIndices) && fits;
+        assert(fits && "a cone triangle spans more than 16-bit indices reach");
+        (void) fits;
+        offset += bodyIndexCount + diskIndexCount;
+    }
+    // Pack for the GPU, keeping the float vertices only as a fallback
+    if (hasHalfFloats) {
+        
+        m_packedVertices.resize(m_coneVertices.size());
+        for (size_t i = 0; i < m_coneVertices.size(); ++i) {
+            
+            const Vertex& source = m_coneVertices[i];
+            vec4 position(source.Position.x, source.Position.y, source.Position.z, 1);
+            FloatToHalf(&position.x, &m_packedVertices[i].Position.x, 4);
+            m_packedVertices[i].Color = PackUnorm8(source.Color);
+        }
+        vector<Vertex>().swap(m_coneVertices);
+        m_vertices = (const unsigned char*) &m_packedVertices[0];
+        m_vertexStride = sizeof(PackedVertex);
+        m_positionAttribute = DescribeAttribute<hvec4>(offsetof(PackedVertex, Position));
+        m_colorAttribute = DescribeAttribute<ubvec4>(offsetof(PackedVertex, Color));
+    } else {
+        
+        m_vertices = (const unsigned char*) &m_coneVertices[0];
+        m_vertexStride = sizeof(Vertex);
+        m_positionAttribute = DescribeAttribute<vec3>(offsetof(Vertex, Position));
+        m_colorAttribute = DescribeAttribute<vec4>(offsetof(Vertex, Color));
+    }
+}
+
+void RenderingEngine2::Render() const {
     
-    GLsizei stride = sizeof(Vertex);
-    const GLvoid* pCoords = &m_coneVertices[0].Position.x;
-    const GLvoid* pColors = &m_coneVertices[0].Color.x;
+    // Record the frame on the pool, then sort and draw it here, on the
+    // context's thread.  There's one object for now, so it records inline.
+    m_queue.Clear();
+    m_queue.Record(m_pool, 1, 1, [this](int, int, CommandList& list) {
+        RecordCone(list);
+    });
+    m_queue.Sort();
     
-    glClearColor(0.5f, 0.5f, 0.5f, 1);
+    m_state.ClearColor(0.5f, 0.5f, 0.5f, 1);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-    glUniformMatrix4fv(modelviewUniform, 1, 0, modelviewMatrix.Pointer());
-    glVertexAttribPointer(positionSlot, 3, GL_FLOAT, GL_FALSE, stride, pCoords);
-    glVertexAttribPointer(colorSlot, 4, GL_FLOAT, GL_FALSE, stride, pColors);
-    glEnableVertexAttribArray(positionSlot);
+    m_queue.Execute(m_state);
+    m_state.EndFrame();
+}
+
+RenderingStats RenderingEngine2::GetStats() const {
     
-    const GLvoid* bodyIndices = &m_coneIndices[0];
-    const GLvoid* diskIndices = &m_coneIndices[m_bodyIndexCount];
+    RenderingStats stats = m_stats;
+    stats.StateCallCount = m_state.GetFrameCallCount();
+    stats.StateFilteredCount = m_state.GetFrameFilteredCount();
+    return stats;
+}
+
+// The cone's per-frame work that needs no GL: its matrix, level and packets.
+void RenderingEngine2::RecordCone(CommandList& list) const {
+    
+    mat4 modelviewMatrix = GetModelView();
+    
+    // What every draw of the cone shares; depth is the eye distance of its origin
+    DrawPacket packet;
+    packet.program = &m_simpleProgram;
+    packet.vertices = m_vertexBuffer;
+    packet.stride = m_vertexStride;
+    PacketAttribute position = { m_positionSlot, true, m_positionAttribute, vec4(0, 0, 0, 1) };
+    PacketAttribute color = { m_colorSlot, true, m_colorAttribute, vec4(1, 1, 1, 1) };
+    packet.attributes[0] = position;
+    packet.attributes[1] = color;
+    packet.attributeCount = 2;
+    packet.uniforms[0].uniform = m_modelviewUniform;
+    std::memcpy(packet.uniforms[0].values, modelviewMatrix.Pointer(), sizeof(packet.uniforms[0].values));
+    packet.uniformCount = 1;
+    packet.depthTest = true;
+    packet.depthWrite = true;
+    packet.blend = BlendNone;
+    packet.depth = -modelviewMatrix.w.z;
+    
+    const ConeLevel& level = m_levels[m_lod.GetCurrentLevel()];
+    Submit(list, level.BodyBatches, packet);
+    packet.attributes[1].array = false;
+    Submit(list, level.DiskBatches, packet);
+}
+
+mat4 RenderingEngine2::GetModelView() const {
     
-    glEnableVertexAttribArray(colorSlot);
-    glDrawElements(GL_TRIANGLES, m_bodyIndexCount, GL_UNSIGNED_BYTE, bodyIndices);
-    glDisableVertexAttribArray(colorSlot);
-    glVertexAttrib4f(1, 1, 1, 1, 1);
-    glDrawElements(GL_TRIANGLES, m_diskIndexCount, GL_UNSIGNED_BYTE, diskIndices);
+    affine3 rotation(mat4::Rotate(m_rotationAngle));
+    affine3 scale = affine3::Scale(m_scale);
+    return (scale * rotation * ViewTranslation).ToMat4();
+}
+
+// Copies each batch's indices into an index buffer object.
+void RenderingEngine2::Upload(const IndexBuffer& indices, vector<DrawBatch>& batches) {
     
-    glDisableVertexAttribArray(positionSlot);
+    batches.clear();
+    for (size_t i = 0; i < indices.GetBatchCount(); ++i) {
+        
+        IndexBatch batch = indices.GetBatch(i);
+        GLsizeiptr size = batch.count * IndexSize(batch.type);
+        DrawBatch draw = {
+            batch.type, batch.count, m_buffers.Upload(GL_ELEMENT_ARRAY_BUFFER, batch.indices, size),
+            (GLintptr) batch.baseVertex * m_vertexStride,
+        };
+        batches.push_back(draw);
+    }
 }
 
-void RenderingEngine2::OnFingerUp(ivec2 location) {
+// One draw call per index batch, with the attributes moved to its base vertex.
+// Queues one packet per batch, each a copy of packet with the batch's indices.
+void RenderingEngine2::Submit(CommandList& list, const vector<DrawBatch>& batches, const DrawPacket& packet) const {
+    
+    for (size_t i = 0; i < batches.size(); ++i) {
+        
+        const DrawBatch& batch = batches[i];
+        DrawPacket draw = packet;
+        draw.vertexOffset = batch.vertexOffset;
+        draw.indices = batch.indices;
+        draw.type = batch.type;
+        draw.count = batch.count;
+        list.Submit(draw);
+    }
+}
 
+bool RenderingEngine2::OnFingerUp(ivec2 location) {
+
+    bool changed = m_scale != 1.0f;
     m_scale = 1.0f;
+    return changed;
 }
 
-void RenderingEngine2::OnFingerDown(ivec2 location) {
+bool RenderingEngine2::OnFingerDown(ivec2 location) {
 
+    bool changed = m_scale != 1.5f;
     m_scale = 1.5f;
+    return changed;
 }
 
-void RenderingEngine2::OnFingerMove(ivec2 previous, ivec2 location) {
+bool RenderingEngine2::OnFingerMove(ivec2 previous, ivec2 location) {
 
     vec2 direction = vec2(location - m_pivotPoint).Normalized();
     
     direction.y = -direction.y;
 
-    m_rotationAngle = std::acos(direction.y) * 180.0f / 3.14159f;
+    float angle = std::acos(direction.y) * 180.0f / 3.14159f;
     
     if (direction.x > 0) {
-        m_rotationAngle = -m_rotationAngle;
+        angle = -angle;
     }
+    bool changed = angle != m_rotationAngle;
+    m_rotationAngle = angle;
+    return changed;
 }
 
-void RenderingEngine2::UpdateAnimation(float timeStep) {
-    
+// Picks the cone's tessellation for the coming frame from how large its
+// center appears on screen.  Only a change of level needs a new frame; the
+// scale that drives it is changed by touches, which report themselves.
+bool RenderingEngine2::UpdateAnimation(float timeStep) {
+    
+    size_t level = m_lod.GetCurrentLevel();
+    float pixelsPerUnit = PixelsPerUnit(GetModelView(), ProjectionMatrix, vec3(0, 0, 0), m_viewportHeight);
+    return m_lod.Select(pixelsPerUnit) != level;
 }
 
-void RenderingEngine2::OnRotate(DeviceOrientation newOrientation) {
+bool RenderingEngine2::OnRotate(DeviceOrientation newOrientation) {
     
+    return false;
 }
 
 GLuint RenderingEngine2::BuildShader(const char* source, GLenum shaderType) const {
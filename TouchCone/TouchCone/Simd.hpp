@@ -0,0 +1,230 @@
+//
+//  Simd.hpp
+//  TouchCone
+//
+//  Created by zhangdl on 19/5/14.
+//  Copyright (c) 2014 com.*. All rights reserved.
+//
+
+#pragma once
+#include <cmath>
+
+// Picks the vector instruction set at compile time.  Define VECTORMATH_SCALAR
+// to force the portable path (handy for checking the SIMD kernels against it).
+#if defined(VECTORMATH_SCALAR)
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+#define VECTORMATH_NEON 1
+#include <arm_neon.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define VECTORMATH_SSE 1
+#include <emmintrin.h>
+#endif
+
+#if defined(VECTORMATH_NEON) || defined(VECTORMATH_SSE)
+#define VECTORMATH_SIMD 1
+#endif
+
+// Four packed floats.  Loads and stores are unaligned because vec4 and mat4
+// only guarantee the alignment of a float.
+namespace Simd {
+
+#if defined(VECTORMATH_SSE)
+
+typedef __m128 float4;
+
+inline float4 Load(const float* p) { return _mm_loadu_ps(p); }
+inline void Store(float* p, float4 v) { _mm_storeu_ps(p, v); }
+inline float4 Splat(float s) { return _mm_set1_ps(s); }
+inline float4 Add(float4 a, float4 b) { return _mm_add_ps(a, b); }
+inline float4 Mul(float4 a, float4 b) { return _mm_mul_ps(a, b); }
+inline float4 MulAdd(float4 a, float4 b, float4 c) { return _mm_add_ps(c, _mm_mul_ps(a, b)); }
+inline float4 Sub(float4 a, float4 b) { return _mm_sub_ps(a, b); }
+inline float4 Abs(float4 a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+inline float4 Min(float4 a, float4 b) { return _mm_min_ps(a, b); }
+inline float4 Round(float4 a) { return _mm_cvtepi32_ps(_mm_cvtps_epi32(a)); }
+
+// a with its sign flipped in every lane where s is negative.
+inline float4 FlipSign(float4 a, float4 s) {
+
+    return _mm_xor_ps(a, _mm_and_ps(s, _mm_set1_ps(-0.0f)));
+}
+
+// The sign bits of lanes 0 to 3 as bits 0 to 3.
+inline int SignMask(float4 a) { return _mm_movemask_ps(a); }
+
+// 1 / sqrt(a) from the hardware estimate plus one Newton-Raphson step.
+inline float4 Rsqrt(float4 a) {
+
+    float4 r = _mm_rsqrt_ps(a);
+    float4 rr = _mm_mul_ps(_mm_mul_ps(a, r), r);
+    return _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(0.5f), r), _mm_sub_ps(_mm_set1_ps(3.0f), rr));
+}
+
+inline void Transpose(float4& r0, float4& r1, float4& r2, float4& r3) {
+
+    _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+}
+
+#elif defined(VECTORMATH_NEON)
+
+typedef float32x4_t float4;
+
+inline float4 Load(const float* p) { return vld1q_f32(p); }
+inline void Store(float* p, float4 v) { vst1q_f32(p, v); }
+inline float4 Splat(float s) { return vdupq_n_f32(s); }
+inline float4 Add(float4 a, float4 b) { return vaddq_f32(a, b); }
+inline float4 Mul(float4 a, float4 b) { return vmulq_f32(a, b); }
+inline float4 MulAdd(float4 a, float4 b, float4 c) { return vaddq_f32(c, vmulq_f32(a, b)); }
+inline float4 Sub(float4 a, float4 b) { return vsubq_f32(a, b); }
+inline float4 Abs(float4 a) { return vabsq_f32(a); }
+inline float4 Min(float4 a, float4 b) { return vminq_f32(a, b); }
+inline float4 Round(float4 a) {
+
+    float4 half = vreinterpretq_f32_u32(vorrq_u32(vreinterpretq_u32_f32(vdupq_n_f32(0.5f)),
+                                                  vandq_u32(vreinterpretq_u32_f32(a), vdupq_n_u32(0x80000000u))));
+    return vcvtq_f32_s32(vcvtq_s32_f32(vaddq_f32(a, half)));
+}
+
+inline float4 FlipSign(float4 a, float4 s) {
+
+    uint32x4_t sign = vandq_u32(vreinterpretq_u32_f32(s), vdupq_n_u32(0x80000000u));
+    return vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(a), sign));
+}
+
+// ARMv7 has no horizontal add, so the shifted bits are summed pairwise.
+inline int SignMask(float4 a) {
+
+    static const int32_t shifts[4] = { 0, 1, 2, 3 };
+    uint32x4_t bits = vshlq_u32(vshrq_n_u32(vreinterpretq_u32_f32(a), 31), vld1q_s32(shifts));
+    uint32x2_t sum = vadd_u32(vget_low_u32(bits), vget_high_u32(bits));
+    return (int) vget_lane_u32(vpadd_u32(sum, sum), 0);
+}
+
+// The NEON estimate is only good to 8 bits, so it takes two refinement steps.
+inline float4 Rsqrt(float4 a) {
+
+    float4 r = vrsqrteq_f32(a);
+    r = vmulq_f32(r, vrsqrtsq_f32(vmulq_f32(a, r), r));
+    return vmulq_f32(r, vrsqrtsq_f32(vmulq_f32(a, r), r));
+}
+
+inline void Transpose(float4& r0, float4& r1, float4& r2, float4& r3) {
+
+    float32x4x2_t t01 = vtrnq_f32(r0, r1);
+    float32x4x2_t t23 = vtrnq_f32(r2, r3);
+    r0 = vcombine_f32(vget_low_f32(t01.val[0]), vget_low_f32(t23.val[0]));
+    r1 = vcombine_f32(vget_low_f32(t01.val[1]), vget_low_f32(t23.val[1]));
+    r2 = vcombine_f32(vget_high_f32(t01.val[0]), vget_high_f32(t23.val[0]));
+    r3 = vcombine_f32(vget_high_f32(t01.val[1]), vget_high_f32(t23.val[1]));
+}
+
+#else
+
+struct float4 {
+
+    float v[4];
+};
+
+inline float4 Load(const float* p) {
+
+    float4 r = {{ p[0], p[1], p[2], p[3] }};
+    return r;
+}
+inline void Store(float* p, float4 a) {
+
+    p[0] = a.v[0]; p[1] = a.v[1]; p[2] = a.v[2]; p[3] = a.v[3];
+}
+inline float4 Splat(float s) {
+
+    float4 r = {{ s, s, s, s }};
+    return r;
+}
+inline float4 Add(float4 a, float4 b) {
+
+    float4 r = {{ a.v[0] + b.v[0], a.v[1] + b.v[1], a.v[2] + b.v[2], a.v[3] + b.v[3] }};
+    return r;
+}
+inline float4 Mul(float4 a, float4 b) {
+
+    float4 r = {{ a.v[0] * b.v[0], a.v[1] * b.v[1], a.v[2] * b.v[2], a.v[3] * b.v[3] }};
+    return r;
+}
+inline float4 MulAdd(float4 a, float4 b, float4 c) {
+
+    return Add(c, Mul(a, b));
+}
+inline float4 Sub(float4 a, float4 b) {
+
+    float4 r = {{ a.v[0] - b.v[0], a.v[1] - b.v[1], a.v[2] - b.v[2], a.v[3] - b.v[3] }};
+    return r;
+}
+inline float4 Abs(float4 a) {
+
+    float4 r = {{ std::fabs(a.v[0]), std::fabs(a.v[1]), std::fabs(a.v[2]), std::fabs(a.v[3]) }};
+    return r;
+}
+inline float4 Min(float4 a, float4 b) {
+
+    float4 r = {{ a.v[0] < b.v[0] ? a.v[0] : b.v[0], a.v[1] < b.v[1] ? a.v[1] : b.v[1],
+                  a.v[2] < b.v[2] ? a.v[2] : b.v[2], a.v[3] < b.v[3] ? a.v[3] : b.v[3] }};
+    return r;
+}
+inline float4 Round(float4 a) {
+
+    float4 r = {{ std::floor(a.v[0] + 0.5f), std::floor(a.v[1] + 0.5f), std::floor(a.v[2] + 0.5f), std::floor(a.v[3] + 0.5f) }};
+    return r;
+}
+inline float4 FlipSign(float4 a, float4 s) {
+
+    for (int i = 0; i < 4; ++i) {
+        if (std::signbit(s.v[i]))
+            a.v[i] = -a.v[i];
+    }
+    return a;
+}
+inline int SignMask(float4 a) {
+
+    int mask = 0;
+    for (int i = 0; i < 4; ++i) {
+        if (std::signbit(a.v[i]))
+            mask |= 1 << i;
+    }
+    return mask;
+}
+inline float4 Rsqrt(float4 a) {
+
+    float4 r = {{ 1 / std::sqrt(a.v[0]), 1 / std::sqrt(a.v[1]), 1 / std::sqrt(a.v[2]), 1 / std::sqrt(a.v[3]) }};
+    return r;
+}
+
+inline void Transpose(float4& r0, float4& r1, float4& r2, float4& r3) {
+
+    float4 t0 = {{ r0.v[0], r1.v[0], r2.v[0], r3.v[0] }};
+    float4 t1 = {{ r0.v[1], r1.v[1], r2.v[1], r3.v[1] }};
+    float4 t2 = {{ r0.v[2], r1.v[2], r2.v[2], r3.v[2] }};
+    float4 t3 = {{ r0.v[3], r1.v[3], r2.v[3], r3.v[3] }};
+    r0 = t0; r1 = t1; r2 = t2; r3 = t3;
+}
+
+#endif
+
+// s[0] * r0 + s[1] * r1 + s[2] * r2 + s[3] * r3, summed left to right so the
+// result matches the hand-written scalar expressions in Matrix.hpp bit for bit.
+inline float4 Combine(const float* s, float4 r0, float4 r1, float4 r2, float4 r3) {
+
+    float4 v = Mul(Splat(s[0]), r0);
+    v = MulAdd(Splat(s[1]), r1, v);
+    v = MulAdd(Splat(s[2]), r2, v);
+    return MulAdd(Splat(s[3]), r3, v);
+}
+
+// Same as Combine with an implicit s[3] of 1, for transforming points.
+inline float4 CombinePoint(const float* s, float4 r0, float4 r1, float4 r2, float4 r3) {
+
+    float4 v = Mul(Splat(s[0]), r0);
+    v = MulAdd(Splat(s[1]), r1, v);
+    v = MulAdd(Splat(s[2]), r2, v);
+    return Add(v, r3);
+}
+
+}
@@ -0,0 +1,138 @@
+//
+//  ThreadPool.hpp
+//  TouchCone
+//
+//  Created by zhangdl on 28/5/14.
+//  Copyright (c) 2014 com.*. All rights reserved.
+//
+
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// A fixed set of worker threads for splitting load-time work, such as mesh
+// generation, into independent pieces.  The thread that calls ParallelFor()
+// works too, so a pool of one thread has no workers and runs everything
+// inline.
+class ThreadPool {
+
+public:
+    // threadCount includes the calling thread; 0 means one per core.
+    explicit ThreadPool(unsigned threadCount = 0);
+    ~ThreadPool();
+    unsigned GetThreadCount() const { return m_workers.size() + 1; }
+    
+    // Calls function(begin, end) for consecutive chunks of [0, count), each
+    // at most grain long, and returns once all of them have run.  Which thread
+    // runs a chunk varies, so chunks must not depend on each other.
+    void ParallelFor(int count, int grain, const std::function<void(int, int)>& function);
+
+private:
+    void RunChunks();
+    void Work();
+    
+    std::vector<std::thread> m_workers;
+    std::mutex m_mutex;
+    std::condition_variable m_start;
+    std::condition_variable m_finish;
+    
+    // The current ParallelFor(), published under m_mutex.
+    const std::function<void(int, int)>* m_function;
+    int m_count;
+    int m_grain;
+    std::atomic<int> m_next;
+    unsigned m_generation;
+    unsigned m_busy;
+    bool m_stopping;
+};
+
+inline ThreadPool::ThreadPool(unsigned threadCount)
+    : m_function(0), m_count(0), m_grain(1), m_next(0), m_generation(0), m_busy(0), m_stopping(false) {
+    
+    if (!threadCount)
+        threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+    for (unsigned i = 1; i < threadCount; ++i) {
+        m_workers.push_back(std::thread(&ThreadPool::Work, this));
+    }
+}
+
+inline ThreadPool::~ThreadPool() {
+    
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_start.notify_all();
+    for (size_t i = 0; i < m_workers.size(); ++i) {
+        m_workers[i].join();
+    }
+}
+
+inline void ThreadPool::ParallelFor(int count, int grain, const std::function<void(int, int)>& function) {
+    
+    grain = std::max(grain, 1);
+    if (count <= grain || m_workers.empty()) {
+        
+        for (int begin = 0; begin < count; begin += grain) {
+            function(begin, std::min(begin + grain, count));
+        }
+        return;
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_function = &function;
+        m_count = count;
+        m_grain = grain;
+        m_next = 0;
+        m_busy = m_workers.size();
+        ++m_generation;
+    }
+    m_start.notify_all();
+    RunChunks();
+    
+    // Every worker checks in, even one that woke too late to get a chunk, so
+    // none of them can still be looking at this call's state afterwards.
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (m_busy)
+        m_finish.wait(lock);
+    m_function = 0;
+}
+
+inline void ThreadPool::RunChunks() {
+    
+    for (;;) {
+        
+        int begin = m_next.fetch_add(m_grain);
+        if (begin >= m_count)
+            break;
+        (*m_function)(begin, std::min(begin + m_grain, m_count));
+    }
+}
+
+inline void ThreadPool::Work() {
+    
+    unsigned generation = 0;
+    for (;;) {
+        
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            while (!m_stopping && m_generation == generation)
+                m_start.wait(lock);
+            if (m_stopping)
+                return;
+            generation = m_generation;
+        }
+        
+        RunChunks();
+        
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!--m_busy)
+            m_finish.notify_one();
+    }
+}
@@ -8,24 +8,27 @@
 
 #pragma once
 #include <cmath>
+#include <cstddef>
+#include <stdint.h>
+#include "Simd.hpp"
 
-const float Pi = 4 * std::atan(1.0f);
-const float TwoPi = 2 * Pi;
+constexpr float Pi = 3.14159265358979323846f;
+constexpr float TwoPi = 2 * Pi;
 
 template <typename T>
 struct Vector2 {
     
     Vector2() {}
-    Vector2(T x, T y):x(x), y(y) {}
-    T Dot(const Vector2& v) const {
+    constexpr Vector2(T x, T y):x(x), y(y) {}
+    constexpr T Dot(const Vector2& v) const {
         
         return x * v.x + y * v.y;
     }
-    Vector2 operator+(const Vector2& v) const {
+    constexpr Vector2 operator+(const Vector2& v) const {
         
         return Vector2(x + v.x, y + v.y);
     }
-    Vector2 operator-(const Vector2& v) const {
+    constexpr Vector2 operator-(const Vector2& v) const {
         
         return Vector2(x - v.x, y - v.y);
     }
@@ -37,11 +40,11 @@ struct Vector2 {
         
         *this = Vector2(x - v.x, y - v.y);
     }
-    Vector2 operator*(float s) const {
+    constexpr Vector2 operator*(float s) const {
         
         return Vector2(x * s, y * s);
     }
-    Vector2 operator/(float s) const {
+    constexpr Vector2 operator/(float s) const {
         
         return Vector2(x / s, y / s);
     }
@@ -65,7 +68,7 @@ struct Vector2 {
         v.Normalize();
         return v;
     }
-    T LengthSquared() const {
+    constexpr T LengthSquared() const {
         
         return x * x + y * y;
     }
@@ -77,15 +80,15 @@ struct Vector2 {
         
         return &x;
     }
-    operator Vector2<float>() const {
+    constexpr operator Vector2<float>() const {
         
         return Vector2<float>(x, y);
     }
-    bool operator==(const Vector2& v) const {
+    constexpr bool operator==(const Vector2& v) const {
         
-        return x == v.x && y = v.y;
+        return x == v.x && y == v.y;
     }
-    Vector2 Lerp(float t, Vector2& v) const {
+    constexpr Vector2 Lerp(float t, const Vector2& v) const {
         
         return Vector2((1 - t) * x + t * v.x,
                        (1 - t) * y + t * v.y);
@@ -105,34 +108,34 @@ template <typename T>
 struct Vector3 {
     
     Vector3() {}
-    Vector3(T x, T y, T z):x(x), y(y), z(z) {}
-    Vector3 Cross(const Vector3& v) const {
+    constexpr Vector3(T x, T y, T z):x(x), y(y), z(z) {}
+    constexpr Vector3 Cross(const Vector3& v) const {
         
         return Vector3(y * v.z - z * v.y,
                        z * v.x - x * v.z,
                        x * v.y - y * v.x);
     }
-    T Dot(const Vector3& v) const {
+    constexpr T Dot(const Vector3& v) const {
         
         return x * v.x + y * v.y + z * v.z;
     }
-    Vector3 operator+(const Vector3& v) const {
+    constexpr Vector3 operator+(const Vector3& v) const {
         
         return Vector3(x + v.x, y + v.y, z + v.z);
     }
-    Vector3 operator-(const Vector3& v) const {
+    constexpr Vector3 operator-(const Vector3& v) const {
         
         return Vector3(x - v.x, y - v.y, z- v.z);
     }
-    Vector3 operator-() const {
+    constexpr Vector3 operator-() const {
         
         return Vector3(-x, -y, -z);
     }
-    Vector3 operator*(T s) const {
+    constexpr Vector3 operator*(T s) const {
         
         return Vector3(x * s, y * s, z * s);
     }
-    Vector3 operator/(T s) const {
+    constexpr Vector3 operator/(T s) const {
         
         return Vector3(x /s , y / s, z / s);
     }
@@ -173,11 +176,11 @@ struct Vector3 {
         
         return std::sqrt(x * x + y * y + z * z);
     }
-    bool operator==(const Vector3& v) const {
+    constexpr bool operator==(const Vector3& v) const {
         
         return x == v.x && y == v.y && z == v.z;
     }
-    Vector3 Lerp(float t, const Vector3& v) const {
+    constexpr Vector3 Lerp(float t, const Vector3& v) const {
         
         return Vector3(x * (1 - t) + v.x * t,
                        y * (1 - t) + v.y * t,
@@ -203,13 +206,25 @@ template <typename T>
 struct Vector4 {
     
     Vector4() {}
-    Vector4(T x, T y, T z, T w):x(x), y(y), z(z), w(w) {}
-    Vector4(const Vector3<T>& v, T w):x(v.x), y(v.y), z(v.z), w(w) {}
-    T Dot(const Vector4& v) {
+    constexpr Vector4(T x, T y, T z, T w):x(x), y(y), z(z), w(w) {}
+    constexpr Vector4(const Vector3<T>& v, T w):x(v.x), y(v.y), z(v.z), w(w) {}
+    constexpr T Dot(const Vector4& v) const {
         
         return x * v.x + y * v.y + z * v.z + w *v.w;
     }
-    Vector4 Lerp(float t, const Vector4& v) const {
+    constexpr Vector4 operator+(const Vector4& v) const {
+        
+        return Vector4(x + v.x, y + v.y, z + v.z, w + v.w);
+    }
+    constexpr Vector4 operator-(const Vector4& v) const {
+        
+        return Vector4(x - v.x, y - v.y, z - v.z, w - v.w);
+    }
+    constexpr Vector4 operator*(T s) const {
+        
+        return Vector4(x * s, y * s, z * s, w * s);
+    }
+    constexpr Vector4 Lerp(float t, const Vector4& v) const {
         
         return Vector4(x * (1 - t) + v.x * t,
                        y * (1 - t) + v.y * t,
@@ -235,3 +250,211 @@ typedef Vector2<float> vec2;
 typedef Vector3<float> vec3;
 typedef Vector4<float> vec4;
 
+// Packed vertex components.  These are storage formats only: build them from
+// float vectors with the Pack functions, unpack them to do math, and let the
+// GPU widen them when fetching.  VertexAttribute.hpp maps each one to its
+// glVertexAttribPointer type and normalization.
+typedef uint16_t half;
+
+typedef Vector3<half> hvec3;        // IEEE half floats
+typedef Vector4<half> hvec4;
+typedef Vector2<int16_t> svec2;     // signed normalized, c / 32767
+typedef Vector4<int16_t> svec4;
+typedef Vector4<uint8_t> ubvec4;    // unsigned normalized, c / 255
+
+// Float to half with round-to-nearest-even; overflow goes to infinity and
+// NaNs stay NaNs.  Fabian Giesen's branch-light formulation.
+inline half FloatToHalf(float value) {
+    
+    union { float f; uint32_t u; } f = { value };
+    const uint32_t sign = f.u & 0x80000000u;
+    f.u ^= sign;
+    
+    uint32_t h;
+    if (f.u >= (127 + 16) << 23) {
+        
+        h = (f.u > 255u << 23) ? 0x7e00 : 0x7c00;
+    } else if (f.u < (127 - 14) << 23) {
+        
+        // Subnormal or zero: let the FPU round the mantissa into place.
+        union { uint32_t u; float f; } magic = { ((127 - 15) + (23 - 10) + 1) << 23 };
+        f.f += magic.f;
+        h = f.u - magic.u;
+    } else {
+        
+        uint32_t mantissaOdd = (f.u >> 13) & 1;
+        f.u += 0xfff + mantissaOdd - ((127u - 15) << 23);
+        h = f.u >> 13;
+    }
+    return (half)(h | (sign >> 16));
+}
+
+inline float HalfToFloat(half value) {
+    
+    union { uint32_t u; float f; } magic = { (254 - 15) << 23 };
+    union { uint32_t u; float f; } o = { (uint32_t)(value & 0x7fff) << 13 };
+    o.f *= magic.f;
+    if (o.f >= 65536.0f)
+        o.u |= 255u << 23;
+    o.u |= (uint32_t)(value & 0x8000) << 16;
+    return o.f;
+}
+
+// Batch conversions, four values per step where the hardware allows it:
+// SSE2 integer ops, or the fp16 conversion instructions on ARMv8 and on
+// ARMv7 cores that have them.  Older NEON parts fall back to the scalar code.
+inline void FloatToHalf(const float* in, half* out, size_t count) {
+    
+    size_t i = 0;
+#if defined(VECTORMATH_SSE)
+    const __m128i signMask = _mm_set1_epi32(0x80000000u);
+    const __m128i f16Max = _mm_set1_epi32((127 + 16) << 23);
+    const __m128i minNormal = _mm_set1_epi32((127 - 14) << 23);
+    const __m128i subnormalMagic = _mm_set1_epi32(((127 - 15) + (23 - 10) + 1) << 23);
+    const __m128i normalBias = _mm_set1_epi32(0xfff - ((127 - 15) << 23));
+    const __m128i nanBit = _mm_set1_epi32(0x200);
+    const __m128i infinity = _mm_set1_epi32(0x7c00);
+    
+    for (; i + 4 <= count; i += 4) {
+        
+        __m128 f = _mm_loadu_ps(in + i);
+        __m128 sign = _mm_and_ps(_mm_castsi128_ps(signMask), f);
+        __m128 absf = _mm_xor_ps(f, sign);
+        __m128i bits = _mm_castps_si128(absf);
+        
+        __m128i isNan = _mm_castps_si128(_mm_cmpunord_ps(absf, absf));
+        __m128i isRegular = _mm_cmpgt_epi32(f16Max, bits);
+        __m128i special = _mm_or_si128(_mm_and_si128(isNan, nanBit), infinity);
+        
+        __m128i isSubnormal = _mm_cmpgt_epi32(minNormal, bits);
+        __m128 subnormalSum = _mm_add_ps(absf, _mm_castsi128_ps(subnormalMagic));
+        __m128i subnormal = _mm_sub_epi32(_mm_castps_si128(subnormalSum), subnormalMagic);
+        
+        __m128i mantissaOdd = _mm_srai_epi32(_mm_slli_epi32(bits, 31 - 13), 31);
+        __m128i normal = _mm_srli_epi32(_mm_sub_epi32(_mm_add_epi32(bits, normalBias), mantissaOdd), 13);
+        
+        __m128i finite = _mm_or_si128(_mm_and_si128(isSubnormal, subnormal), _mm_andnot_si128(isSubnormal, normal));
+        __m128i h = _mm_or_si128(_mm_and_si128(isRegular, finite), _mm_andnot_si128(isRegular, special));
+        
+        // The arithmetic shift keeps every lane in int16 range, so the
+        // saturating pack passes the low 16 bits through untouched.
+        h = _mm_or_si128(h, _mm_srai_epi32(_mm_castps_si128(sign), 16));
+        _mm_storel_epi64((__m128i*)(out + i), _mm_packs_epi32(h, h));
+    }
+#elif defined(VECTORMATH_NEON) && (defined(__aarch64__) || (defined(__ARM_FP) && (__ARM_FP & 2)))
+    for (; i + 4 <= count; i += 4) {
+        vst1_u16(out + i, vreinterpret_u16_f16(vcvt_f16_f32(vld1q_f32(in + i))));
+    }
+#endif
+    for (; i < count; ++i) {
+        out[i] = FloatToHalf(in[i]);
+    }
+}
+
+inline void HalfToFloat(const half* in, float* out, size_t count) {
+    
+    size_t i = 0;
+#if defined(VECTORMATH_SSE)
+    const __m128i noSign = _mm_set1_epi32(0x7fff);
+    const __m128 magic = _mm_castsi128_ps(_mm_set1_epi32((254 - 15) << 23));
+    const __m128i maxFinite = _mm_set1_epi32(0x7bff);
+    const __m128 infinityExponent = _mm_castsi128_ps(_mm_set1_epi32(255 << 23));
+    
+    for (; i + 4 <= count; i += 4) {
+        
+        __m128i h = _mm_unpacklo_epi16(_mm_loadl_epi64((const __m128i*)(in + i)), _mm_setzero_si128());
+        __m128i magnitude = _mm_and_si128(h, noSign);
+        __m128 scaled = _mm_mul_ps(_mm_castsi128_ps(_mm_slli_epi32(magnitude, 13)), magic);
+        __m128 infNan = _mm_and_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(magnitude, maxFinite)), infinityExponent);
+        __m128 sign = _mm_castsi128_ps(_mm_slli_epi32(_mm_xor_si128(h, magnitude), 16));
+        _mm_storeu_ps(out + i, _mm_or_ps(scaled, _mm_or_ps(sign, infNan)));
+    }
+#elif defined(VECTORMATH_NEON) && (defined(__aarch64__) || (defined(__ARM_FP) && (__ARM_FP & 2)))
+    for (; i + 4 <= count; i += 4) {
+        vst1q_f32(out + i, vcvt_f32_f16(vreinterpret_f16_u16(vld1_u16(in + i))));
+    }
+#endif
+    for (; i < count; ++i) {
+        out[i] = HalfToFloat(in[i]);
+    }
+}
+
+inline hvec3 PackHalf(const vec3& v) {
+    
+    return hvec3(FloatToHalf(v.x), FloatToHalf(v.y), FloatToHalf(v.z));
+}
+
+inline hvec4 PackHalf(const vec4& v) {
+    
+    return hvec4(FloatToHalf(v.x), FloatToHalf(v.y), FloatToHalf(v.z), FloatToHalf(v.w));
+}
+
+inline vec3 UnpackHalf(const hvec3& v) {
+    
+    return vec3(HalfToFloat(v.x), HalfToFloat(v.y), HalfToFloat(v.z));
+}
+
+inline vec4 UnpackHalf(const hvec4& v) {
+    
+    return vec4(HalfToFloat(v.x), HalfToFloat(v.y), HalfToFloat(v.z), HalfToFloat(v.w));
+}
+
+// c = round(v * 32767) as in ES 3.0.  ES 2.0 drivers may decode it as
+// (2c + 1) / 65535 instead, which is off by at most 1.5e-5.
+inline int16_t PackSnorm16(float v) {
+    
+    v = v < -1 ? -1 : (v > 1 ? 1 : v);
+    return (int16_t)std::floor(v * 32767 + 0.5f);
+}
+
+inline uint8_t PackUnorm8(float v) {
+    
+    v = v < 0 ? 0 : (v > 1 ? 1 : v);
+    return (uint8_t)(v * 255 + 0.5f);
+}
+
+inline svec4 PackSnorm16(const vec4& v) {
+    
+    return svec4(PackSnorm16(v.x), PackSnorm16(v.y), PackSnorm16(v.z), PackSnorm16(v.w));
+}
+
+inline ubvec4 PackUnorm8(const vec4& v) {
+    
+    return ubvec4(PackUnorm8(v.x), PackUnorm8(v.y), PackUnorm8(v.z), PackUnorm8(v.w));
+}
+
+// Octahedral normal encoding: the unit sphere is projected onto an
+// octahedron and unfolded into a square, so a normal fits in two snorm16s
+// with an angular error under 0.004 degrees.  Decode with UnpackOctahedral
+// or the same few lines in the vertex shader.
+inline svec2 PackOctahedral(const vec3& n) {
+    
+    float s = 1 / (std::fabs(n.x) + std::fabs(n.y) + std::fabs(n.z));
+    float x = n.x * s;
+    float y = n.y * s;
+    if (n.z < 0) {
+        
+        float fx = (1 - std::fabs(y)) * (x < 0 ? -1 : 1);
+        float fy = (1 - std::fabs(x)) * (y < 0 ? -1 : 1);
+        x = fx;
+        y = fy;
+    }
+    return svec2(PackSnorm16(x), PackSnorm16(y));
+}
+
+inline vec3 UnpackOctahedral(const svec2& e) {
+    
+    float x = e.x / 32767.0f;
+    float y = e.y / 32767.0f;
+    float z = 1 - std::fabs(x) - std::fabs(y);
+    if (z < 0) {
+        
+        float fx = (1 - std::fabs(y)) * (x < 0 ? -1 : 1);
+        float fy = (1 - std::fabs(x)) * (y < 0 ? -1 : 1);
+        x = fx;
+        y = fy;
+    }
+    vec3 n(x, y, z);
+    n.Normalize();
+    return n;
+}
@@ -0,0 +1,67 @@
+//
+//  VertexAttribute.hpp
+//  TouchCone
+//
+//  Created by zhangdl on 21/5/14.
+//  Copyright (c) 2014 com.*. All rights reserved.
+//
+
+#pragma once
+#include "GLES2.hpp"
+#include "GLState.hpp"
+#include "IndexBuffer.hpp"
+#include "MeshFile.hpp"
+#include "Vector.hpp"
+
+// Size, component type and normalization of each vertex component type, so
+// an attribute is bound from its C++ type instead of hand-written arguments.
+template <typename V> struct VertexAttribute;
+
+#define VERTEX_ATTRIBUTE(V, size, type, normalized) \
+    template <> struct VertexAttribute<V> { \
+        static const GLint Size = size; \
+        static const GLenum Type = type; \
+        static const GLboolean Normalized = normalized; \
+    }
+
+VERTEX_ATTRIBUTE(vec2, 2, GL_FLOAT, GL_FALSE);
+VERTEX_ATTRIBUTE(vec3, 3, GL_FLOAT, GL_FALSE);
+VERTEX_ATTRIBUTE(vec4, 4, GL_FLOAT, GL_FALSE);
+VERTEX_ATTRIBUTE(hvec3, 3, GL_HALF_FLOAT_OES, GL_FALSE);
+VERTEX_ATTRIBUTE(hvec4, 4, GL_HALF_FLOAT_OES, GL_FALSE);
+VERTEX_ATTRIBUTE(svec2, 2, GL_SHORT, GL_TRUE);
+VERTEX_ATTRIBUTE(svec4, 4, GL_SHORT, GL_TRUE);
+VERTEX_ATTRIBUTE(ubvec4, 4, GL_UNSIGNED_BYTE, GL_TRUE);
+
+#undef VERTEX_ATTRIBUTE
+
+template <typename V>
+inline void VertexAttribPointer(GLuint slot, GLsizei stride, const V* first) {
+    
+    typedef VertexAttribute<V> Attribute;
+    glVertexAttribPointer(slot, Attribute::Size, Attribute::Type, Attribute::Normalized, stride, first);
+}
+
+// The same description as a MeshAttribute record, for a member offset bytes
+// into the vertex.
+template <typename V>
+inline MeshAttribute DescribeAttribute(size_t offset) {
+    
+    typedef VertexAttribute<V> Attribute;
+    MeshAttribute result = { Attribute::Size, Attribute::Type, Attribute::Normalized, (uint32_t) offset };
+    return result;
+}
+
+inline void VertexAttribPointer(GLState& state, GLuint slot, const MeshAttribute& attribute,
+                                GLsizei stride, const void* first) {
+    
+    state.VertexAttribPointer(slot, attribute.Size, attribute.Type, attribute.Normalized, stride,
+                              (const unsigned char*) first + attribute.Offset);
+}
+
+// Half-float attributes need OES_vertex_half_float.  Every iOS GPU has it,
+// but check before relying on it.
+inline bool HasHalfFloatVertices() {
+    
+    return HasExtension(glGetString(GL_EXTENSIONS), "GL_OES_vertex_half_float");
+}
@@ -0,0 +1,96 @@
+//
+//  AffineTests.cpp
+//  TouchConeTests
+//
+//  Created by zhangdl on 6/6/14.
+//  Copyright (c) 2014 com.*. All rights reserved.
+//
+//  Affine3 against the Matrix4 it stands in for, on random transforms:
+//  composing has to agree with multiplying the full matrices, and both
+//  inverses have to give back the identity.
+//
+
+#include <cmath>
+#include <cstdio>
+#include "Check.hpp"
+#include "Matrix.hpp"
+
+static const int Count = 1000;
+
+static float MaxError(const mat4& a, const mat4& b) {
+    
+    const float* p = a.Pointer();
+    const float* q = b.Pointer();
+    float error = 0;
+    for (int k = 0; k < 16; ++k) {
+        error = fmaxf(error, fabsf(p[k] - q[k]));
+    }
+    return error;
+}
+
+static vec3 RandomVector(CheckRandom& random, float range) {
+    
+    return vec3(random.Float(-range, range), random.Float(-range, range), random.Float(-range, range));
+}
+
+// A rotation about a random axis followed by a translation.
+static affine3 RandomRigid(CheckRandom& random) {
+    
+    vec3 axis = RandomVector(random, 1);
+    while (axis.Dot(axis) < 0.01f)
+        axis = RandomVector(random, 1);
+    axis.Normalize();
+    affine3 rotation(mat4::Rotate(random.Float(-180, 180), axis));
+    vec3 t = RandomVector(random, 10);
+    return rotation * affine3::Translate(t.x, t.y, t.z);
+}
+
+// Any linear part that's comfortably invertible, plus a translation.
+static affine3 RandomAffine(CheckRandom& random) {
+    
+    for (;;) {
+        
+        affine3 a(RandomVector(random, 2), RandomVector(random, 2), RandomVector(random, 2), RandomVector(random, 10));
+        if (fabsf(a.x.Dot(a.y.Cross(a.z))) > 0.5f)
+            return a;
+    }
+}
+
+int main() {
+    
+    CheckRandom random;
+    const mat4 identity;
+    float composeError = 0, inverseError = 0, rigidError = 0;
+    for (int i = 0; i < Count; ++i) {
+        
+        affine3 a = RandomAffine(random);
+        affine3 b = RandomAffine(random);
+        composeError = fmaxf(composeError, MaxError((a * b).ToMat4(), a.ToMat4() * b.ToMat4()));
+        inverseError = fmaxf(inverseError, MaxError((a * a.Inverted()).ToMat4(), identity));
+        inverseError = fmaxf(inverseError, MaxError((a.Inverted() * a).ToMat4(), identity));
+        
+        affine3 r = RandomRigid(random);
+        rigidError = fmaxf(rigidError, MaxError((r * r.InvertedRigid()).ToMat4(), identity));
+        rigidError = fmaxf(rigidError, MaxError(r.InvertedRigid().ToMat4(), r.Inverted().ToMat4()));
+    }
+    printf("max error: compose %g, inverse %g, rigid inverse %g\n", composeError, inverseError, rigidError);
+    
+    // Composing skips only the products with the 0 0 0 1 column, so the
+    // sums come out the same; inverting goes through a division
+    CHECK(composeError < 1e-4f);
+    CHECK(inverseError < 1e-4f);
+    CHECK(rigidError < 1e-4f);
+    
+    // ToMat4 keeps the 0 0 0 1 column and the conversion round-trips
+    affine3 a = RandomAffine(random);
+    mat4 m = a.ToMat4();
+    CHECK(m.x.w == 0 && m.y.w == 0 && m.z.w == 0 && m.w.w == 1);
+    CHECK(MaxError(affine3(m).ToMat4(), m) == 0);
+    
+    // TransformPoint is what the shader does with the uploaded matrix
+    vec3 p = RandomVector(random, 10);
+    vec4 shader = m.Transposed() * vec4(p, 1);
+    vec3 q = a.TransformPoint(p);
+    CHECK(fabsf(q.x - shader.x) < 1e-4f && fabsf(q.y - shader.y) < 1e-4f && fabsf(q.z - shader.z) < 1e-4f);
+    return CheckResult();
+}
@@ -0,0 +1,54 @@
+//
+//  Check.hpp
+//  TouchConeTests
+//
+//  Created by zhangdl on 5/6/14.
+//  Copyright (c) 2014 com.*. All rights reserved.
+//
+
+#pragma once
+#include <cstdio>
+
+// The few lines the C++ tests need instead of a framework.  Each test is an
+// executable that CMakeLists.txt registers with CTest; CHECK reports a
+// failure and carries on, and main returns CheckResult(), which fails the
+// test if any CHECK did.
+
+inline int& CheckFailureCount() {
+    
+    static int count = 0;
+    return count;
+}
+
+inline bool Check(bool passed, const char* condition, const char* file, int line) {
+    
+    if (!passed) {
+        
+        std::printf("%s:%d: CHECK(%s) failed\n", file, line, condition);
+        ++CheckFailureCount();
+    }
+    return passed;
+}
+
+#define CHECK(condition) Check((condition), #condition, __FILE__, __LINE__)
+
+inline int CheckResult() {
+    
+    if (CheckFailureCount())
+        std::printf("%d checks failed\n", CheckFailureCount());
+    return CheckFailureCount() ? 1 : 0;
+}
+
+// A 32-bit LCG, so every run and every build sees the same inputs.
+class CheckRandom {
+
+public:
+    explicit CheckRandom(unsigned seed = 1) : m_state(seed) {}
+    unsigned Next() { return m_state = m_state * 1664525u + 1013904223u; }
+    
+    // Uniform in [low, high).
+    float Float(float low, float high) { return low + (high - low) * (Next() >> 8) / 16777216.0f; }
+
+private:
+    unsigned m_state;
+};
@@ -0,0 +1,204 @@
+//
+//  FrustumTests.cpp
+//  TouchConeTests
+//
+//  Created by zhangdl on 6/6/14.
+//  Copyright (c) 2014 com.*. All rights reserved.
+//
+//  The frustum culling kernels against a scalar reference: hand-placed
+//  spheres and boxes inside, outside and straddling each plane, then random
+//  ones at counts that leave a partial vector and a partial bit word.
+//
+
+#include <cmath>
+#include <vector>
+#include "Check.hpp"
+#include "Frustum.hpp"
+
+using namespace std;
+
+struct Sphere {
+    
+    float x, y, z, radius;
+};
+
+struct Box {
+    
+    float x, y, z, extentX, extentY, extentZ;
+};
+
+// Smallest signed distance over the planes, in double, so it doesn't share
+// the kernels' rounding.
+static double Nearest(const vec4* planes, const Sphere& s) {
+    
+    double nearest = 1e30;
+    for (int k = 0; k < FrustumPlaneCount; ++k) {
+        
+        const vec4& p = planes[k];
+        nearest = fmin(nearest, (double) p.x * s.x + (double) p.y * s.y + (double) p.z * s.z + p.w + s.radius);
+    }
+    return nearest;
+}
+
+static double Nearest(const vec4* planes, const Box& b) {
+    
+    double nearest = 1e30;
+    for (int k = 0; k < FrustumPlaneCount; ++k) {
+        
+        const vec4& p = planes[k];
+        double radius = fabs(p.x) * b.extentX + fabs(p.y) * b.extentY + fabs(p.z) * b.extentZ;
+        nearest = fmin(nearest, (double) p.x * b.x + (double) p.y * b.y + (double) p.z * b.z + p.w + radius);
+    }
+    return nearest;
+}
+
+// Runs the kernel into a buffer whose unused bits start out set, and checks
+// that the bits past count come back cleared.
+static vector<uint32_t> Cull(const vec4* planes, const vector<Sphere>& spheres) {
+    
+    size_t count = spheres.size();
+    vector<float> x(count + 1), y(count + 1), z(count + 1), radius(count + 1);
+    for (size_t i = 0; i < count; ++i) {
+        
+        x[i] = spheres[i].x;
+        y[i] = spheres[i].y;
+        z[i] = spheres[i].z;
+        radius[i] = spheres[i].radius;
+    }
+    vector<uint32_t> visible((count + 31) / 32 + 1, ~0u);
+    CullSpheres(planes, &x[0], &y[0], &z[0], &radius[0], &visible[0], count);
+    if (count % 32)
+        CHECK(visible[count / 32] >> (count % 32) == 0);
+    CHECK(visible.back() == ~0u);
+    return visible;
+}
+
+static vector<uint32_t> Cull(const vec4* planes, const vector<Box>& boxes) {
+    
+    size_t count = boxes.size();
+    vector<float> x(count + 1), y(count + 1), z(count + 1), ex(count + 1), ey(count + 1), ez(count + 1);
+    for (size_t i = 0; i < count; ++i) {
+        
+        x[i] = boxes[i].x;
+        y[i] = boxes[i].y;
+        z[i] = boxes[i].z;
+        ex[i] = boxes[i].extentX;
+        ey[i] = boxes[i].extentY;
+        ez[i] = boxes[i].extentZ;
+    }
+    vector<uint32_t> visible((count + 31) / 32 + 1, ~0u);
+    CullBoxes(planes, &x[0], &y[0], &z[0], &ex[0], &ey[0], &ez[0], &visible[0], count);
+    if (count % 32)
+        CHECK(visible[count / 32] >> (count % 32) == 0);
+    CHECK(visible.back() == ~0u);
+    return visible;
+}
+
+// Near plane at 1, far at 10, 90 degrees across in both directions, with
+// the camera at z in world space, looking down -z.
+static void MakePlanes(float z, vec4* planes) {
+    
+    ExtractFrustumPlanes(mat4::Translate(0, 0, -z) * mat4::Frustum(-1, 1, -1, 1, 1, 10), planes);
+    
+    // Unit normals, pointing inward
+    for (int k = 0; k < FrustumPlaneCount; ++k) {
+        
+        const vec4& p = planes[k];
+        CHECK(fabs(p.x * p.x + p.y * p.y + p.z * p.z - 1) < 1e-6);
+        CHECK(p.x * 0 + p.y * 0 + p.z * (z - 5) + p.w > 0);
+    }
+}
+
+static void TestKnown(const vec4* planes) {
+    
+    const Sphere spheres[] = {
+        { 0, 0, -5, 0.5f },         // inside
+        { 0, 0, 5, 1 },             // behind the camera
+        { 100, 0, -5, 1 },          // off to the right
+        { 0, -100, -5, 1 },         // below
+        { 0, 0, -20, 1 },           // past the far plane
+        { 0, 0, -10, 1 },           // straddling the far plane
+        { 0, 0, -0.5f, 1 },         // straddling the near plane
+        { 5.5f, 0, -5, 1 },         // straddling the right plane
+        { 0, 0, 0, 100 },           // around the whole frustum
+    };
+    const bool expected[] = { true, false, false, false, false, true, true, true, true };
+    const size_t count = sizeof(spheres) / sizeof(spheres[0]);
+    vector<uint32_t> visible = Cull(planes, vector<Sphere>(spheres, spheres + count));
+    for (size_t i = 0; i < count; ++i) {
+        CHECK(IsVisible(&visible[0], i) == expected[i]);
+    }
+    
+    // A box can reach a plane with its corner where a sphere of the same
+    // half-width wouldn't
+    const Box boxes[] = {
+        { 0, 0, -5, 0.5f, 0.5f, 0.5f },
+        { 0, 0, 5, 1, 1, 1 },
+        { 100, 0, -5, 1, 1, 1 },
+        { 0, 0, -20, 1, 1, 1 },
+        { 0, 0, -10, 1, 1, 1 },
+        { 0, 0, -0.5f, 1, 1, 1 },
+        { 5.5f, 0, -5, 1, 1, 1 },
+        { 0, 0, 0, 100, 100, 100 },
+        { 0, 0, -12, 0.1f, 0.1f, 3 },   // long in z, reaching back past the far plane
+    };
+    const bool expectedBoxes[] = { true, false, false, false, true, true, true, true, true };
+    const size_t boxCount = sizeof(boxes) / sizeof(boxes[0]);
+    visible = Cull(planes, vector<Box>(boxes, boxes + boxCount));
+    for (size_t i = 0; i < boxCount; ++i) {
+        CHECK(IsVisible(&visible[0], i) == expectedBoxes[i]);
+    }
+}
+
+// Random bounds around the frustum, at counts that are and aren't multiples
+// of 4 and 32.  Ones within rounding of a plane are left out of the
+// comparison, since the reference doesn't round the same way.
+static void TestRandom(const vec4* planes) {
+    
+    CheckRandom random;
+    const size_t counts[] = { 1, 3, 4, 5, 31, 32, 33, 64, 101, 1000 };
+    size_t visibleCount = 0, culledCount = 0;
+    for (size_t c = 0; c < sizeof(counts) / sizeof(counts[0]); ++c) {
+        
+        size_t count = counts[c];
+        vector<Sphere> spheres(count);
+        vector<Box> boxes(count);
+        for (size_t i = 0; i < count; ++i) {
+            
+            Sphere s = { random.Float(-12, 12), random.Float(-12, 12), random.Float(-14, 4), random.Float(0, 2) };
+            Box b = { random.Float(-12, 12), random.Float(-12, 12), random.Float(-14, 4),
+                      random.Float(0, 2), random.Float(0, 2), random.Float(0, 2) };
+            spheres[i] = s;
+            boxes[i] = b;
+        }
+        vector<uint32_t> sphereBits = Cull(planes, spheres);
+        vector<uint32_t> boxBits = Cull(planes, boxes);
+        for (size_t i = 0; i < count; ++i) {
+            
+            double d = Nearest(planes, spheres[i]);
+            if (fabs(d) > 1e-4)
+                CHECK(IsVisible(&sphereBits[0], i) == (d > 0));
+            d = Nearest(planes, boxes[i]);
+            if (fabs(d) > 1e-4)
+                CHECK(IsVisible(&boxBits[0], i) == (d > 0));
+            IsVisible(&sphereBits[0], i) ? ++visibleCount : ++culledCount;
+        }
+    }
+    
+    // Both outcomes turn up often enough to mean something
+    CHECK(visibleCount > 100 && culledCount > 100);
+}
+
+int main() {
+    
+    vec4 planes[FrustumPlaneCount];
+    MakePlanes(0, planes);
+    TestKnown(planes);
+    TestRandom(planes);
+    
+    // Again with the origin inside, so the zeros padding a short vector
+    // come out visible and have to be masked off
+    MakePlanes(3, planes);
+    TestRandom(planes);
+    return CheckResult();
+}
@@ -0,0 +1,103 @@
+//
+//  IndexBufferTests.cpp
+//  TouchConeTests
+//
+//  Created by zhangdl on 6/6/14.
+//  Copyright (c) 2014 com.*. All rights reserved.
+//
+//  IndexBuffer's choice of index width, and the 16-bit split used without
+//  OES_element_index_uint: the batches have to give back every triangle,
+//  and a triangle no 16-bit window can hold has to be reported.
+//
+
+#include <stdint.h>
+#include <vector>
+#include "Check.hpp"
+#include "IndexBuffer.hpp"
+
+using namespace std;
+
+// The triangles the batches draw, as absolute vertex indices.
+static vector<unsigned> Expand(const IndexBuffer& buffer) {
+    
+    vector<unsigned> indices;
+    for (size_t b = 0; b < buffer.GetBatchCount(); ++b) {
+        
+        IndexBatch batch = buffer.GetBatch(b);
+        for (int i = 0; i < batch.count; ++i) {
+            
+            unsigned index = batch.type == IndexTypeByte ? ((const uint8_t*) batch.indices)[i]
+                           : batch.type == IndexTypeShort ? ((const uint16_t*) batch.indices)[i]
+                           : ((const uint32_t*) batch.indices)[i];
+            indices.push_back(index + batch.baseVertex);
+        }
+    }
+    return indices;
+}
+
+// A strip of triangles, written as a list, over vertices first to last.
+static vector<unsigned> Strip(unsigned first, unsigned last) {
+    
+    vector<unsigned> indices;
+    for (unsigned v = first; v + 2 <= last; ++v) {
+        
+        indices.push_back(v);
+        indices.push_back(v + 1);
+        indices.push_back(v + 2);
+    }
+    return indices;
+}
+
+static void TestWidths() {
+    
+    // The width follows the range used, not the largest index
+    IndexBuffer buffer;
+    vector<unsigned> indices = Strip(1000, 1255);
+    CHECK(buffer.Assign(&indices[0], indices.size(), false));
+    CHECK(buffer.GetBatchCount() == 1 && buffer.GetBatch(0).type == IndexTypeByte);
+    CHECK(buffer.GetBatch(0).baseVertex == 1000);
+    CHECK(Expand(buffer) == indices);
+    
+    indices = Strip(70000, 70000 + 0xFFFF);
+    CHECK(buffer.Assign(&indices[0], indices.size(), false));
+    CHECK(buffer.GetBatchCount() == 1 && buffer.GetBatch(0).type == IndexTypeShort);
+    CHECK(Expand(buffer) == indices);
+    
+    indices = Strip(0, 200000);
+    CHECK(buffer.Assign(&indices[0], indices.size(), true));
+    CHECK(buffer.GetBatchCount() == 1 && buffer.GetBatch(0).type == IndexTypeInt);
+    CHECK(Expand(buffer) == indices);
+    
+    CHECK(buffer.Assign(0, 0, false));
+    CHECK(buffer.GetBatchCount() == 0);
+}
+
+static void TestSplit() {
+    
+    // Without 32-bit indices, 16-bit windows that keep every triangle
+    IndexBuffer buffer;
+    vector<unsigned> indices = Strip(0, 200000);
+    CHECK(buffer.Assign(&indices[0], indices.size(), false));
+    CHECK(buffer.GetBatchCount() == 4);
+    for (size_t b = 0; b < buffer.GetBatchCount(); ++b) {
+        CHECK(buffer.GetBatch(b).type == IndexTypeShort);
+    }
+    CHECK(Expand(buffer) == indices);
+    
+    // A triangle spanning more than 16 bits is left out and reported
+    const unsigned spanning[] = { 0, 1, 2, 10, 11, 70000, 3, 4, 80000 };
+    CHECK(!buffer.Assign(spanning, 9, false));
+    vector<unsigned> kept = Expand(buffer);
+    CHECK(kept.size() == 3 && kept[0] == 0 && kept[1] == 1 && kept[2] == 2);
+    
+    // With 32-bit indices nothing is lost
+    CHECK(buffer.Assign(spanning, 9, true));
+    CHECK(Expand(buffer) == vector<unsigned>(spanning, spanning + 9));
+}
+
+int main() {
+    
+    TestWidths();
+    TestSplit();
+    return CheckResult();
+}
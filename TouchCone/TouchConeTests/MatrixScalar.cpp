@@ -0,0 +1,61 @@
+//
+//  MatrixScalar.cpp
+//  TouchConeTests
+//
+//  Created by zhangdl on 5/6/14.
+//  Copyright (c) 2014 com.*. All rights reserved.
+//
+//  The reference half of MatrixTests: the generic Matrix4 template, as a
+//  VECTORMATH_SCALAR build compiles it.  The headers go in a namespace of
+//  their own so their inline functions can't be merged with the SIMD ones
+//  MatrixTests.cpp instantiates; the standard headers they include are
+//  included first, outside it.
+//
+
+#define VECTORMATH_SCALAR
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <stdint.h>
+
+namespace Scalar {
+#include "Matrix.hpp"
+}
+
+#if VECTORMATH_SIMD
+#error MatrixScalar.cpp must build the scalar template
+#endif
+
+// a * b for each of count pairs of 16-float matrices.
+void ScalarMultiply(const float* a, const float* b, float* product, int count) {
+    
+    for (int i = 0; i < count; ++i) {
+        
+        Scalar::mat4 m(a + 16 * i), n(b + 16 * i);
+        Scalar::mat4 p = m * n;
+        std::memcpy(product + 16 * i, p.Pointer(), 16 * sizeof(float));
+    }
+}
+
+// m * v for each of count matrices and 4-float vectors.
+void ScalarTransform(const float* m, const float* v, float* product, int count) {
+    
+    for (int i = 0; i < count; ++i) {
+        
+        const float* u = v + 4 * i;
+        Scalar::mat4 a(m + 16 * i);
+        Scalar::vec4 b(u[0], u[1], u[2], u[3]);
+        Scalar::vec4 p = a * b;
+        std::memcpy(product + 4 * i, p.Pointer(), 4 * sizeof(float));
+    }
+}
+
+void ScalarTranspose(const float* m, float* transposed, int count) {
+    
+    for (int i = 0; i < count; ++i) {
+        
+        Scalar::mat4 a(m + 16 * i);
+        Scalar::mat4 t = a.Transposed();
+        std::memcpy(transposed + 16 * i, t.Pointer(), 16 * sizeof(float));
+    }
+}
@@ -0,0 +1,131 @@
+//
+//  MatrixTests.cpp
+//  TouchConeTests
+//
+//  Created by zhangdl on 5/6/14.
+//  Copyright (c) 2014 com.*. All rights reserved.
+//
+//  The SIMD Matrix4<float> kernels against the generic template on random
+//  inputs.  Matrix.hpp promises the same results, not just close ones, so
+//  they're compared bit for bit.  Without SSE or NEON both sides are the
+//  template and the test only checks itself.  The batched TransformPoints
+//  overloads are held to the same standard against the single-vector
+//  product they stand in for.
+//
+
+#include <cstring>
+#include <vector>
+#include "Check.hpp"
+#include "Matrix.hpp"
+
+using namespace std;
+
+void ScalarMultiply(const float* a, const float* b, float* product, int count);
+void ScalarTransform(const float* m, const float* v, float* product, int count);
+void ScalarTranspose(const float* m, float* transposed, int count);
+
+static const int Count = 10000;
+
+static bool Same(const vec4& a, const vec4& b) {
+    
+    return !memcmp(a.Pointer(), b.Pointer(), 4 * sizeof(float));
+}
+
+// Every overload against m.Transposed() * vec4(p, 1), at counts that do and
+// don't fill the four-wide loop.
+static void TestTransformPoints(CheckRandom& random) {
+    
+    // Points inside an interleaved vertex, so the stride isn't sizeof(vec3)
+    struct Vertex {
+        
+        vec3 Position;
+        float Extra[2];
+    };
+    
+    const size_t counts[] = { 0, 1, 3, 4, 7, 1001 };
+    for (size_t c = 0; c < sizeof(counts) / sizeof(counts[0]); ++c) {
+        
+        size_t count = counts[c];
+        float r[16];
+        for (int k = 0; k < 16; ++k) {
+            r[k] = random.Float(-10, 10);
+        }
+        mat4 m(r);
+        mat4 t = m.Transposed();
+        
+        vector<Vertex> vertices(count + 1);
+        vector<vec3> points(count + 1);
+        vector<vec4> points4(count + 1);
+        vector<float> xs(count + 1), ys(count + 1), zs(count + 1);
+        for (size_t i = 0; i < count; ++i) {
+            
+            vec3 p(random.Float(-100, 100), random.Float(-100, 100), random.Float(-100, 100));
+            vertices[i].Position = p;
+            points[i] = p;
+            points4[i] = vec4(p, random.Float(-2, 2));
+            xs[i] = p.x;
+            ys[i] = p.y;
+            zs[i] = p.z;
+        }
+        
+        // One past the end, to catch a kernel that writes too far
+        const vec4 sentinel(12345, 12345, 12345, 12345);
+        vector<vec4> strided(count + 1, sentinel), packed(count + 1, sentinel), full(count + 1, sentinel);
+        vector<float> outX(count + 1, 12345), outY(count + 1, 12345), outZ(count + 1, 12345), outW(count + 1, 12345);
+        TransformPoints(m, &vertices[0].Position, sizeof(Vertex), &strided[0], count);
+        TransformPoints(m, &points[0], &packed[0], count);
+        TransformPoints(m, &points4[0], &full[0], count);
+        TransformPoints(m, &xs[0], &ys[0], &zs[0], &outX[0], &outY[0], &outZ[0], &outW[0], count);
+        
+        for (size_t i = 0; i < count; ++i) {
+            
+            vec4 expected = t * vec4(points[i], 1);
+            CHECK(Same(strided[i], expected));
+            CHECK(Same(packed[i], expected));
+            CHECK(Same(full[i], t * points4[i]));
+            CHECK(Same(vec4(outX[i], outY[i], outZ[i], outW[i]), expected));
+        }
+        CHECK(Same(strided[count], sentinel) && Same(packed[count], sentinel) && Same(full[count], sentinel));
+        CHECK(outX[count] == 12345 && outY[count] == 12345 && outZ[count] == 12345 && outW[count] == 12345);
+    }
+}
+
+int main() {
+    
+    // Each side reads the same floats
+    CheckRandom random;
+    vector<float> a(16 * Count), b(16 * Count), v(4 * Count);
+    for (size_t i = 0; i < a.size(); ++i) {
+        
+        a[i] = random.Float(-100, 100);
+        b[i] = random.Float(-100, 100);
+    }
+    for (size_t i = 0; i < v.size(); ++i) {
+        v[i] = random.Float(-100, 100);
+    }
+    
+    vector<float> products(16 * Count), transformed(4 * Count), transposed(16 * Count);
+    for (int i = 0; i < Count; ++i) {
+        
+        mat4 m(&a[16 * i]), n(&b[16 * i]);
+        vec4 u(v[4 * i], v[4 * i + 1], v[4 * i + 2], v[4 * i + 3]);
+        mat4 product = m * n;
+        vec4 transform = m * u;
+        mat4 transpose = m.Transposed();
+        memcpy(&products[16 * i], product.Pointer(), 16 * sizeof(float));
+        memcpy(&transformed[4 * i], transform.Pointer(), 4 * sizeof(float));
+        memcpy(&transposed[16 * i], transpose.Pointer(), 16 * sizeof(float));
+    }
+    
+    vector<float> expectedProducts(16 * Count), expectedTransformed(4 * Count), expectedTransposed(16 * Count);
+    ScalarMultiply(&a[0], &b[0], &expectedProducts[0], Count);
+    ScalarTransform(&a[0], &v[0], &expectedTransformed[0], Count);
+    ScalarTranspose(&a[0], &expectedTransposed[0], Count);
+    
+    CHECK(!memcmp(&products[0], &expectedProducts[0], products.size() * sizeof(float)));
+    CHECK(!memcmp(&transformed[0], &expectedTransformed[0], transformed.size() * sizeof(float)));
+    CHECK(!memcmp(&transposed[0], &expectedTransposed[0], transposed.size() * sizeof(float)));
+    
+    TestTransformPoints(random);
+    return CheckResult();
+}
@@ -0,0 +1,187 @@
+//
+//  MeshFileTests.cpp
+//  TouchConeTests
+//
+//  Created by zhangdl on 6/6/14.
+//  Copyright (c) 2014 com.*. All rights reserved.
+//
+//  The mesh cache on disk: a written mesh has to map back byte for byte, and
+//  a file with the wrong key, cut short, or with any section, batch or index
+//  pointing outside what it holds has to be refused rather than drawn from.
+//
+
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include "Check.hpp"
+#include "MeshFile.hpp"
+
+using namespace std;
+
+static const uint64_t Key = 0x1234567890ABCDEFull;
+static const uint32_t VertexCount = 300;
+static const uint32_t Stride = 12;
+
+static vector<unsigned char> ReadFile(const string& path) {
+    
+    vector<unsigned char> bytes;
+    FILE* in = fopen(path.c_str(), "rb");
+    if (!in)
+        return bytes;
+    int c;
+    while ((c = fgetc(in)) != EOF) {
+        bytes.push_back((unsigned char) c);
+    }
+    fclose(in);
+    return bytes;
+}
+
+static void WriteFile(const string& path, const vector<unsigned char>& bytes) {
+    
+    FILE* out = fopen(path.c_str(), "wb");
+    if (!bytes.empty())
+        fwrite(&bytes[0], bytes.size(), 1, out);
+    fclose(out);
+}
+
+// The indices a buffer draws, as absolute vertex numbers.
+static vector<unsigned> Expand(const IndexBuffer& buffer) {
+    
+    vector<unsigned> indices;
+    for (size_t b = 0; b < buffer.GetBatchCount(); ++b) {
+        
+        IndexBatch batch = buffer.GetBatch(b);
+        for (int i = 0; i < batch.count; ++i) {
+            
+            unsigned index = batch.type == IndexTypeByte ? ((const uint8_t*) batch.indices)[i]
+                           : batch.type == IndexTypeShort ? ((const uint16_t*) batch.indices)[i]
+                           : ((const uint32_t*) batch.indices)[i];
+            indices.push_back(index + batch.baseVertex);
+        }
+    }
+    return indices;
+}
+
+// Whether the file at path, after patch changes a copy of original, opens.
+template <typename T>
+static bool OpensWith(const string& path, const vector<unsigned char>& original, size_t offset, T value) {
+    
+    vector<unsigned char> bytes = original;
+    memcpy(&bytes[offset], &value, sizeof(value));
+    WriteFile(path, bytes);
+    MappedMesh mesh;
+    return mesh.Open(path.c_str(), Key);
+}
+
+int main() {
+    
+    char directory[] = "/tmp/MeshFileTestsXXXXXX";
+    if (!mkdtemp(directory)) {
+        
+        printf("can't create a temporary directory\n");
+        return 1;
+    }
+    string path = string(directory) + "/Test.mesh";
+    
+    // Two groups: one narrow enough for bytes, one that needs shorts
+    vector<unsigned char> vertices(VertexCount * Stride);
+    for (size_t i = 0; i < vertices.size(); ++i) {
+        vertices[i] = (unsigned char) (i * 7 + 3);
+    }
+    vector<unsigned> small, large;
+    for (unsigned v = 10; v + 2 < 60; ++v) {
+        
+        small.push_back(v);
+        small.push_back(v + 1);
+        small.push_back(v + 2);
+    }
+    for (unsigned v = 0; v + 2 < VertexCount; v += 3) {
+        
+        large.push_back(v);
+        large.push_back(VertexCount - 1 - v);
+        large.push_back(v + 1);
+    }
+    IndexBuffer groups[2];
+    groups[0].Assign(&small[0], small.size(), false);
+    groups[1].Assign(&large[0], large.size(), false);
+    CHECK(groups[0].GetBatch(0).type == IndexTypeByte && groups[1].GetBatch(0).type == IndexTypeShort);
+    MeshAttribute attributes[] = { { 3, 0x1406, 0, 0 } };
+    CHECK(WriteMeshFile(path.c_str(), Key, &vertices[0], VertexCount, Stride, attributes, 1, groups, 2));
+    vector<unsigned char> original = ReadFile(path);
+    
+    // Round trip
+    {
+        MappedMesh mesh;
+        CHECK(mesh.Open(path.c_str(), Key));
+        const MeshFileHeader& header = mesh.GetHeader();
+        CHECK(header.VertexCount == VertexCount && header.VertexStride == Stride);
+        CHECK(header.GroupCount == 2 && header.AttributeCount == 1);
+        CHECK(!memcmp(&header.Attributes[0], &attributes[0], sizeof(MeshAttribute)));
+        CHECK(!memcmp(mesh.GetVertices(), &vertices[0], vertices.size()));
+        IndexBuffer small2, large2;
+        mesh.GetIndices(0, small2);
+        mesh.GetIndices(1, large2);
+        CHECK(Expand(small2) == small);
+        CHECK(Expand(large2) == large);
+    }
+    
+    // Wrong key, missing file
+    {
+        MappedMesh mesh;
+        CHECK(!mesh.Open(path.c_str(), Key + 1));
+        CHECK(!mesh.IsOpen());
+        CHECK(!mesh.Open((path + ".missing").c_str(), Key));
+    }
+    
+    // Cut short anywhere, including inside the header
+    const size_t lengths[] = { 0, 16, sizeof(MeshFileHeader) - 1, sizeof(MeshFileHeader), original.size() / 2, original.size() - 1 };
+    for (size_t i = 0; i < sizeof(lengths) / sizeof(lengths[0]); ++i) {
+        
+        WriteFile(path, vector<unsigned char>(original.begin(), original.begin() + lengths[i]));
+        MappedMesh mesh;
+        CHECK(!mesh.Open(path.c_str(), Key));
+    }
+    
+    // Corrupted fields; the file size in the header still matches
+    MeshFileHeader header;
+    memcpy(&header, &original[0], sizeof(header));
+    size_t batch0 = header.BatchOffset;
+    size_t batch1 = header.BatchOffset + sizeof(MeshFileBatch);
+    CHECK(OpensWith(path, original, offsetof(MeshFileHeader, Reserved), (uint32_t) 0));
+    CHECK(!OpensWith(path, original, batch0 + offsetof(MeshFileBatch, Offset), ~0ull - 1));
+    CHECK(!OpensWith(path, original, batch0 + offsetof(MeshFileBatch, Offset), (uint64_t) (original.size() - header.IndexOffset + 16)));
+    CHECK(!OpensWith(path, original, batch0 + offsetof(MeshFileBatch, Count), ~0u));
+    CHECK(!OpensWith(path, original, batch1 + offsetof(MeshFileBatch, Count), (uint32_t) (original.size())));
+    CHECK(!OpensWith(path, original, batch0 + offsetof(MeshFileBatch, Type), (uint32_t) 7));
+    CHECK(!OpensWith(path, original, batch0 + offsetof(MeshFileBatch, Group), (uint32_t) 2));
+    CHECK(!OpensWith(path, original, offsetof(MeshFileHeader, VertexOffset), ~0ull - 15));
+    CHECK(!OpensWith(path, original, offsetof(MeshFileHeader, BatchOffset), ~0ull - 15));
+    CHECK(!OpensWith(path, original, offsetof(MeshFileHeader, IndexOffset), ~0ull - 15));
+    CHECK(!OpensWith(path, original, offsetof(MeshFileHeader, BatchCount), ~0u));
+    CHECK(!OpensWith(path, original, offsetof(MeshFileHeader, VertexStride), ~0u));
+    CHECK(!OpensWith(path, original, offsetof(MeshFileHeader, AttributeCount), (uint32_t) (MaxMeshAttributes + 1)));
+    CHECK(!OpensWith(path, original, offsetof(MeshFileHeader, Magic), (uint32_t) 0));
+    
+    // Indices that would fetch past the last vertex: fewer vertices than the
+    // largest index, a base vertex that pushes the range over, and one index
+    // rewritten in place
+    uint32_t largest = VertexCount - 1;
+    CHECK(!OpensWith(path, original, offsetof(MeshFileHeader, VertexCount), largest));
+    MeshFileBatch first;
+    memcpy(&first, &original[batch0], sizeof(first));
+    CHECK(first.Type == IndexTypeByte && first.BaseVertex == 10);
+    uint32_t span = 59 - first.BaseVertex;
+    CHECK(!OpensWith(path, original, batch0 + offsetof(MeshFileBatch, BaseVertex), VertexCount - span));
+    CHECK(OpensWith(path, original, batch0 + offsetof(MeshFileBatch, BaseVertex), VertexCount - span - 1));
+    MeshFileBatch second;
+    memcpy(&second, &original[batch1], sizeof(second));
+    CHECK(second.Type == IndexTypeShort && second.BaseVertex == 0);
+    CHECK(!OpensWith(path, original, header.IndexOffset + second.Offset + 2 * 5, (uint16_t) VertexCount));
+    CHECK(OpensWith(path, original, header.IndexOffset + second.Offset + 2 * 5, (uint16_t) (VertexCount - 1)));
+    
+    remove(path.c_str());
+    rmdir(directory);
+    return CheckResult();
+}
@@ -0,0 +1,128 @@
+//
+//  MeshOptimizerTests.cpp
+//  TouchConeTests
+//
+//  Created by zhangdl on 6/6/14.
+//  Copyright (c) 2014 com.*. All rights reserved.
+//
+//  The MeshOptimizer passes on a grid whose triangles are shuffled, so that
+//  the input has next to no vertex reuse: the vertex cache pass has to bring
+//  the ACMR well down and keep every triangle, and OptimizeMesh has to report
+//  the improvement.
+//
+
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+#include "Check.hpp"
+#include "MeshOptimizer.hpp"
+#include "ParametricSurface.hpp"
+
+using namespace std;
+
+struct Vertex {
+    
+    vec3 Position;
+};
+
+static const int Slices = 64;
+static const int Stacks = 64;
+
+static void MakeGrid(vector<Vertex>& vertices, vector<unsigned>& indices) {
+    
+    Grid grid(1, 1, Slices, Stacks);
+    vertices.resize(grid.GetVertexCount());
+    indices.resize(grid.GetTriangleIndexCount());
+    grid.Generate(&vertices[0].Position, 0, sizeof(Vertex), &indices[0]);
+}
+
+// Fisher-Yates over whole triangles.
+static void ShuffleTriangles(vector<unsigned>& indices) {
+    
+    CheckRandom random;
+    for (size_t t = indices.size() / 3; t > 1; --t) {
+        
+        size_t u = random.Next() % t;
+        swap_ranges(&indices[3 * (t - 1)], &indices[3 * t], &indices[3 * u]);
+    }
+}
+
+// The triangles as sorted triples, to compare two orders of one mesh.
+static vector<vector<unsigned> > Triangles(const vector<unsigned>& indices) {
+    
+    vector<vector<unsigned> > triangles;
+    for (size_t i = 0; i + 3 <= indices.size(); i += 3) {
+        triangles.push_back(vector<unsigned>(&indices[i], &indices[i] + 3));
+    }
+    sort(triangles.begin(), triangles.end());
+    return triangles;
+}
+
+static void TestVertexCache() {
+    
+    vector<Vertex> vertices;
+    vector<unsigned> indices;
+    MakeGrid(vertices, indices);
+    float ordered = ComputeACMR(&indices[0], indices.size(), vertices.size());
+    ShuffleTriangles(indices);
+    vector<unsigned> shuffled = indices;
+    float before = ComputeACMR(&indices[0], indices.size(), vertices.size());
+    
+    vector<size_t> clusters;
+    OptimizeVertexCache(&indices[0], indices.size(), vertices.size(), &clusters);
+    float after = ComputeACMR(&indices[0], indices.size(), vertices.size());
+    printf("grid ACMR: rows %.3f, shuffled %.3f, optimized %.3f, %zu clusters\n",
+           ordered, before, after, clusters.size());
+    
+    CHECK(before > 2.5f);
+    CHECK(after < 0.8f);
+    CHECK(after < ordered);
+    CHECK(Triangles(indices) == Triangles(shuffled));
+    
+    // Clusters start at triangle boundaries, in order
+    CHECK(clusters.size() > 1 && clusters[0] == 0);
+    for (size_t c = 1; c < clusters.size(); ++c) {
+        CHECK(clusters[c] % 3 == 0 && clusters[c] > clusters[c - 1] && clusters[c] < indices.size());
+    }
+    
+    // Sorting the clusters keeps the triangles and most of the gain
+    OptimizeOverdraw(&indices[0], indices.size(), vertices, clusters);
+    CHECK(Triangles(indices) == Triangles(shuffled));
+    CHECK(ComputeACMR(&indices[0], indices.size(), vertices.size()) < 0.9f);
+}
+
+static void TestMesh() {
+    
+    // Two groups, each a shuffled grid over the same vertices, plus a copy of
+    // every vertex for the welding to merge
+    vector<Vertex> vertices;
+    vector<unsigned> indices;
+    MakeGrid(vertices, indices);
+    ShuffleTriangles(indices);
+    size_t vertexCount = vertices.size();
+    size_t groupSize = indices.size();
+    vector<Vertex> copies = vertices;
+    vertices.insert(vertices.end(), copies.begin(), copies.end());
+    for (size_t i = 0; i < groupSize; ++i) {
+        indices.push_back(indices[i] + (unsigned) vertexCount);
+    }
+    vector<size_t> groupSizes(2, groupSize);
+    
+    MeshReport report = OptimizeMesh(vertices, indices, &groupSizes[0], groupSizes.size());
+    CHECK(report.vertexCountBefore == 2 * vertexCount);
+    CHECK(report.vertexCountAfter == vertexCount);
+    CHECK(report.acmrAfter < 0.5f * report.acmrBefore);
+    CHECK(indices.size() == 2 * groupSize);
+    
+    // Each group is still a whole grid
+    vector<unsigned> first(indices.begin(), indices.begin() + groupSize);
+    vector<unsigned> second(indices.begin() + groupSize, indices.end());
+    CHECK(Triangles(first) == Triangles(second));
+}
+
+int main() {
+    
+    TestVertexCache();
+    TestMesh();
+    return CheckResult();
+}
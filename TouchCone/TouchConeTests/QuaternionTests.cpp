@@ -0,0 +1,133 @@
+//
+//  QuaternionTests.cpp
+//  TouchConeTests
+//
+//  Created by zhangdl on 5/6/14.
+//  Copyright (c) 2014 com.*. All rights reserved.
+//
+//  BlendQuaternions against the error bounds its comment documents: each
+//  mode against an exact slerp worked in double, and the Slerp mode against
+//  QuaternionT::Slerp where that takes its trig path.  The count isn't a
+//  multiple of four, so the padded tail is covered too.
+//
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "Check.hpp"
+#include "Quaternion.hpp"
+
+using namespace std;
+
+static const size_t Count = 100003;
+
+// xyzw distance.
+static double Distance(const double* a, const Quaternion& b) {
+    
+    double x = a[0] - b.x, y = a[1] - b.y, z = a[2] - b.z, w = a[3] - b.w;
+    return sqrt(x * x + y * y + z * z + w * w);
+}
+
+// Shorter-arc slerp, in double.
+static void ExactSlerp(const Quaternion& a, const Quaternion& b, float t, double* q) {
+    
+    double dot = (double) a.x * b.x + (double) a.y * b.y + (double) a.z * b.z + (double) a.w * b.w;
+    double sign = dot < 0 ? -1 : 1;
+    double theta = acos(min(fabs(dot), 1.0));
+    double fa = 1 - t, fb = t;
+    if (theta > 1e-9) {
+        
+        fa = sin((1 - t) * theta) / sin(theta);
+        fb = sin(t * theta) / sin(theta);
+    }
+    q[0] = fa * a.x + sign * fb * b.x;
+    q[1] = fa * a.y + sign * fb * b.y;
+    q[2] = fa * a.z + sign * fb * b.z;
+    q[3] = fa * a.w + sign * fb * b.w;
+}
+
+static Quaternion RandomRotation(CheckRandom& random) {
+    
+    Quaternion q;
+    do {
+        
+        q = Quaternion(random.Float(-1, 1), random.Float(-1, 1), random.Float(-1, 1), random.Float(-1, 1));
+    } while (q.Dot(q) < 0.01f || q.Dot(q) > 1);
+    q.Normalize();
+    return q;
+}
+
+int main() {
+    
+    // Half the pairs anywhere on the sphere, half close together, where the
+    // polynomials are least accurate.
+    CheckRandom random;
+    vector<float> a[4], b[4], t(Count);
+    for (int k = 0; k < 4; ++k) {
+        
+        a[k].resize(Count);
+        b[k].resize(Count);
+    }
+    vector<Quaternion> qa(Count), qb(Count);
+    for (size_t i = 0; i < Count; ++i) {
+        
+        qa[i] = RandomRotation(random);
+        qb[i] = RandomRotation(random);
+        if (i % 2) {
+            
+            float s = random.Float(0, 0.05f);
+            qb[i] = Quaternion(qa[i].x + s * qb[i].x, qa[i].y + s * qb[i].y, qa[i].z + s * qb[i].z,
+                               qa[i].w + s * qb[i].w);
+            qb[i].Normalize();
+        }
+        const float* pa = &qa[i].x;
+        const float* pb = &qb[i].x;
+        for (int k = 0; k < 4; ++k) {
+            
+            a[k][i] = pa[k];
+            b[k][i] = pb[k];
+        }
+        t[i] = random.Float(0, 1);
+    }
+    
+    ConstQuaternionArray in0(&a[0][0], &a[1][0], &a[2][0], &a[3][0]);
+    ConstQuaternionArray in1(&b[0][0], &b[1][0], &b[2][0], &b[3][0]);
+    vector<float> out[4];
+    for (int k = 0; k < 4; ++k) {
+        out[k].resize(Count);
+    }
+    QuaternionArray blended(&out[0][0], &out[1][0], &out[2][0], &out[3][0]);
+    
+    double nlerpError = 0, slerpError = 0, shoemakeError = 0;
+    const QuaternionBlend modes[] = { QuaternionBlendNlerp, QuaternionBlendSlerp };
+    for (int m = 0; m < 2; ++m) {
+        
+        BlendQuaternions(modes[m], in0, in1, &t[0], blended, Count);
+        for (size_t i = 0; i < Count; ++i) {
+            
+            double exact[4];
+            ExactSlerp(qa[i], qb[i], t[i], exact);
+            Quaternion q(out[0][i], out[1][i], out[2][i], out[3][i]);
+            double& error = modes[m] == QuaternionBlendNlerp ? nlerpError : slerpError;
+            error = max(error, Distance(exact, q));
+            
+            // QuaternionT::Slerp doesn't take the shorter arc, so give it b
+            // on a's side.
+            if (modes[m] != QuaternionBlendSlerp)
+                continue;
+            Quaternion other = qa[i].Dot(qb[i]) < 0 ? qb[i].Scaled(-1) : qb[i];
+            if (qa[i].Dot(other) < 1 - 0.0005f) {
+                
+                Quaternion s = qa[i].Slerp(t[i], other);
+                double shoemake[4] = { s.x, s.y, s.z, s.w };
+                shoemakeError = max(shoemakeError, Distance(shoemake, q));
+            }
+        }
+    }
+    printf("largest error: nlerp %.2g, slerp %.2g, slerp against QuaternionT::Slerp %.2g\n",
+           nlerpError, slerpError, shoemakeError);
+    CHECK(nlerpError < 4e-4);
+    CHECK(slerpError < 3e-5);
+    CHECK(shoemakeError < 3e-5);
+    return CheckResult();
+}
@@ -0,0 +1,129 @@
+//
+//  RenderQueueTests.cpp
+//  TouchConeTests
+//
+//  Created by zhangdl on 6/6/14.
+//  Copyright (c) 2014 com.*. All rights reserved.
+//
+//  RenderQueue's promise that the draw order doesn't depend on how a frame
+//  was recorded: many objects, with plenty of equal keys, are recorded on
+//  pools of several sizes and in chunks of several grains, and every sorted
+//  order has to match a stable sort of the packets in submission order.
+//  Runs on the GLDispatch null backend, since nothing is drawn.
+//
+
+#include <algorithm>
+#include <stdint.h>
+#include <vector>
+#include "Check.hpp"
+#include "GLDispatch.hpp"
+#include "RenderQueue.hpp"
+
+using namespace std;
+
+static const int ObjectCount = 2000;
+static const int MaxPacketsPerObject = 3;
+
+struct Scene {
+    
+    Program programs[3];
+    BufferHandle vertices[3];
+    BufferHandle indices[2];
+};
+
+// Object i's packets depend only on i, never on the thread recording them.
+// A packet's vertexOffset is its identity.
+static void RecordObject(const Scene& scene, int i, CommandList& list) {
+    
+    CheckRandom random(i + 1);
+    int packetCount = 1 + random.Next() % MaxPacketsPerObject;
+    for (int k = 0; k < packetCount; ++k) {
+        
+        DrawPacket packet = {};
+        packet.program = &scene.programs[random.Next() % 3];
+        packet.vertices = scene.vertices[random.Next() % 3];
+        packet.vertexOffset = i * MaxPacketsPerObject + k;
+        packet.indices = scene.indices[random.Next() % 2];
+        packet.type = IndexTypeShort;
+        packet.count = 3;
+        packet.depthTest = random.Next() % 4 != 0;
+        packet.depthWrite = random.Next() % 2 != 0;
+        const BlendMode blends[] = { BlendNone, BlendNone, BlendNone, BlendAlpha, BlendAdditive };
+        packet.blend = blends[random.Next() % 5];
+        packet.depth = 5 + (random.Next() % 40) * 0.125f;     // few distinct depths, so keys tie
+        list.Submit(packet);
+    }
+}
+
+static vector<GLintptr> Order(const RenderQueue& queue) {
+    
+    vector<GLintptr> order;
+    for (size_t i = 0; i < queue.GetPacketCount(); ++i) {
+        order.push_back(queue.GetPacket(i).vertexOffset);
+    }
+    return order;
+}
+
+int main() {
+    
+    LoadNullGL();
+    GLState state;
+    BufferManager buffers(state);
+    Scene scene;
+    for (int p = 0; p < 3; ++p) {
+        scene.programs[p].Attach(glCreateProgram());
+    }
+    
+    // Big enough that every range gets a block of its own
+    vector<unsigned char> data(BufferManager::BlockSize * 3 / 4);
+    for (int v = 0; v < 3; ++v) {
+        scene.vertices[v] = buffers.Upload(GL_ARRAY_BUFFER, &data[0], data.size());
+    }
+    for (int x = 0; x < 2; ++x) {
+        scene.indices[x] = buffers.Upload(GL_ELEMENT_ARRAY_BUFFER, &data[0], data.size());
+    }
+    
+    // The reference: a stable sort by key of every packet as submitted
+    CommandList all(buffers);
+    for (int i = 0; i < ObjectCount; ++i) {
+        RecordObject(scene, i, all);
+    }
+    vector<pair<uint64_t, size_t> > keys;
+    for (size_t i = 0; i < all.GetPacketCount(); ++i) {
+        keys.push_back(make_pair(all.GetKey(i), i));
+    }
+    stable_sort(keys.begin(), keys.end(), [](const pair<uint64_t, size_t>& a, const pair<uint64_t, size_t>& b) {
+        return a.first < b.first;
+    });
+    vector<GLintptr> expected;
+    for (size_t i = 0; i < keys.size(); ++i) {
+        expected.push_back(all.GetPacket(keys[i].second).vertexOffset);
+    }
+    CHECK(keys.front().first != keys.back().first);
+    
+    // One queue across every run, so lists left over from a bigger frame
+    // are reused by the next
+    RenderQueue queue(buffers);
+    const unsigned threadCounts[] = { 1, 2, 3, 4, 8 };
+    const int grains[] = { ObjectCount, 64, 7, 1 };
+    for (unsigned t = 0; t < sizeof(threadCounts) / sizeof(threadCounts[0]); ++t) {
+        
+        ThreadPool pool(threadCounts[t]);
+        for (unsigned g = 0; g < sizeof(grains) / sizeof(grains[0]); ++g) {
+            
+            queue.Clear();
+            queue.Record(pool, ObjectCount, grains[g], [&scene](int begin, int end, CommandList& list) {
+                
+                for (int i = begin; i < end; ++i) {
+                    RecordObject(scene, i, list);
+                }
+            });
+            queue.Sort();
+            CHECK(Order(queue) == expected);
+            for (size_t i = 1; i < queue.GetPacketCount(); ++i) {
+                CHECK(queue.GetKey(i - 1) <= queue.GetKey(i));
+            }
+        }
+    }
+    return CheckResult();
+}
@@ -0,0 +1,145 @@
+//
+//  SkinningTests.cpp
+//  TouchConeTests
+//
+//  Created by zhangdl on 6/6/14.
+//  Copyright (c) 2014 com.*. All rights reserved.
+//
+//  SkinVertices against the scalar transforms it packs: the dual-quaternion
+//  kernel against DualQuaternion::Blend and TransformPoint, the matrix kernel
+//  against a weighted sum of the Affine3 bones, for one to four influences
+//  per vertex.  With one influence the two methods describe the same rigid
+//  motion and have to agree with each other as well.
+//
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include "Check.hpp"
+#include "Quaternion.hpp"
+
+using namespace std;
+
+static const int BoneCount = 32;
+static const size_t VertexCount = 1003;     // not a multiple of four
+static const float Tolerance = 5e-6f;
+
+static float Distance(const vec3& a, const vec3& b) {
+    
+    return fmaxf(fabsf(a.x - b.x), fmaxf(fabsf(a.y - b.y), fabsf(a.z - b.z)));
+}
+
+static vec3 RandomVector(CheckRandom& random) {
+    
+    return vec3(random.Float(-1, 1), random.Float(-1, 1), random.Float(-1, 1));
+}
+
+struct Skeleton {
+    
+    vector<DualQuaternion> bones;
+    vector<affine3> matrices;
+    vector<vec4> dualQuaternionPalette;
+    vector<vec4> matrixPalette;
+    
+    explicit Skeleton(CheckRandom& random) : dualQuaternionPalette(2 * BoneCount), matrixPalette(3 * BoneCount) {
+        
+        for (int i = 0; i < BoneCount; ++i) {
+            
+            vec3 axis = RandomVector(random);
+            while (axis.Dot(axis) < 0.01f)
+                axis = RandomVector(random);
+            axis.Normalize();
+            Quaternion rotation = Quaternion::CreateFromAxisAngle(axis, random.Float(-3.14159f, 3.14159f));
+            bones.push_back(DualQuaternion(rotation, RandomVector(random)));
+            matrices.push_back(affine3(bones.back().ToMatrix()));
+        }
+        PackPalette(&bones[0], BoneCount, &dualQuaternionPalette[0]);
+        PackPalette(&matrices[0], BoneCount, &matrixPalette[0]);
+    }
+};
+
+static void TestInfluences(const Skeleton& skeleton, int influences, CheckRandom& random) {
+    
+    vector<ubvec4> bones(VertexCount);
+    vector<vec4> weights(VertexCount);
+    vector<vec3> positions(VertexCount), normals(VertexCount);
+    for (size_t i = 0; i < VertexCount; ++i) {
+        
+        // Unused slots keep a weight of 0 and some valid bone
+        uint8_t b[4];
+        float w[4], sum = 0;
+        for (int k = 0; k < 4; ++k) {
+            
+            b[k] = (uint8_t) (random.Next() % BoneCount);
+            w[k] = k < influences ? random.Float(0.05f, 1) : 0;
+            sum += w[k];
+        }
+        bones[i] = ubvec4(b[0], b[1], b[2], b[3]);
+        weights[i] = vec4(w[0] / sum, w[1] / sum, w[2] / sum, w[3] / sum);
+        positions[i] = RandomVector(random);
+        normals[i] = RandomVector(random);
+        normals[i].Normalize();
+    }
+    
+    vector<vec3> dqPositions(VertexCount), dqNormals(VertexCount);
+    vector<vec3> matrixPositions(VertexCount), matrixNormals(VertexCount);
+    SkinVertices(SkinningDualQuaternion, &skeleton.dualQuaternionPalette[0], &bones[0], &weights[0],
+                 &positions[0], &normals[0], &dqPositions[0], &dqNormals[0], VertexCount);
+    SkinVertices(SkinningMatrix, &skeleton.matrixPalette[0], &bones[0], &weights[0],
+                 &positions[0], &normals[0], &matrixPositions[0], &matrixNormals[0], VertexCount);
+    
+    // Without normals the positions don't change
+    vector<vec3> positionsOnly(VertexCount);
+    SkinVertices(SkinningDualQuaternion, &skeleton.dualQuaternionPalette[0], &bones[0], &weights[0],
+                 &positions[0], 0, &positionsOnly[0], 0, VertexCount);
+    CHECK(!memcmp(&positionsOnly[0], &dqPositions[0], VertexCount * sizeof(vec3)));
+    
+    float dqError = 0, matrixError = 0, crossError = 0;
+    for (size_t i = 0; i < VertexCount; ++i) {
+        
+        const uint8_t* b = &bones[i].x;
+        const float* w = &weights[i].x;
+        DualQuaternion q[4] = { skeleton.bones[b[0]], skeleton.bones[b[1]], skeleton.bones[b[2]], skeleton.bones[b[3]] };
+        DualQuaternion blend = DualQuaternion::Blend(q, w, 4);
+        dqError = fmaxf(dqError, Distance(dqPositions[i], blend.TransformPoint(positions[i])));
+        dqError = fmaxf(dqError, Distance(dqNormals[i], blend.TransformVector(normals[i])));
+        
+        vec3 position(0, 0, 0), normal(0, 0, 0);
+        for (int k = 0; k < 4; ++k) {
+            
+            const affine3& m = skeleton.matrices[b[k]];
+            position = position + m.TransformPoint(positions[i]) * w[k];
+            normal = normal + m.TransformVector(normals[i]) * w[k];
+        }
+        matrixError = fmaxf(matrixError, Distance(matrixPositions[i], position));
+        matrixError = fmaxf(matrixError, Distance(matrixNormals[i], normal));
+        
+        crossError = fmaxf(crossError, Distance(dqPositions[i], matrixPositions[i]));
+        crossError = fmaxf(crossError, Distance(dqNormals[i], matrixNormals[i]));
+    }
+    printf("%d influences: dual quaternion %g, matrix %g, between methods %g\n",
+           influences, dqError, matrixError, crossError);
+    CHECK(dqError < Tolerance);
+    CHECK(matrixError < Tolerance);
+    if (influences == 1)
+        CHECK(crossError < Tolerance);
+}
+
+int main() {
+    
+    CheckRandom random;
+    Skeleton skeleton(random);
+    
+    // The packed matrices are the same rigid transforms
+    for (int i = 0; i < BoneCount; ++i) {
+        
+        vec3 p = RandomVector(random);
+        CHECK(Distance(skeleton.matrices[i].TransformPoint(p), skeleton.bones[i].TransformPoint(p)) < Tolerance);
+    }
+    
+    for (int influences = 1; influences <= 4; ++influences) {
+        TestInfluences(skeleton, influences, random);
+    }
+    return CheckResult();
+}
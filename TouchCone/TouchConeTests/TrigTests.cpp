@@ -0,0 +1,104 @@
+//
+//  TrigTests.cpp
+//  TouchConeTests
+//
+//  Created by zhangdl on 6/6/14.
+//  Copyright (c) 2014 com.*. All rights reserved.
+//
+//  The accuracy Trig.hpp promises, against double sin and cos over the whole
+//  documented range, for the scalar, four-wide and array forms; and the exact
+//  angles SinCosSteps promises for rings.
+//
+
+#include <cmath>
+#include <cstdio>
+#include <vector>
+#include "Check.hpp"
+#include "Trig.hpp"
+
+using namespace std;
+
+static const float Range = 8192;
+static const int Count = 1 << 20;
+
+// The largest error of any form of SinCos at this precision.
+static double MaxError(TrigPrecision precision) {
+    
+    CheckRandom random;
+    vector<float> radians(Count);
+    for (int i = 0; i < Count; ++i) {
+        
+        // Half of them near zero, where the error is relative to small values
+        float range = (i & 1) ? Range : 4;
+        radians[i] = random.Float(-range, range);
+    }
+    
+    // An odd count leaves the array form a tail
+    size_t count = Count - 3;
+    vector<float> s(count), c(count);
+    SinCos(&radians[0], &s[0], &c[0], count, precision);
+    
+    double error = 0;
+    for (size_t i = 0; i < count; ++i) {
+        
+        float ss, sc;
+        SinCos(radians[i], ss, sc, precision);
+        float vs[4], vc[4];
+        Simd::float4 ws, wc;
+        SinCos(Simd::Splat(radians[i]), ws, wc, precision);
+        Simd::Store(vs, ws);
+        Simd::Store(vc, wc);
+        
+        double x = radians[i];
+        double expectedS = sin(x), expectedC = cos(x);
+        error = fmax(error, fmax(fabs(s[i] - expectedS), fabs(c[i] - expectedC)));
+        error = fmax(error, fmax(fabs(ss - expectedS), fabs(sc - expectedC)));
+        error = fmax(error, fmax(fabs(vs[0] - expectedS), fabs(vc[0] - expectedC)));
+    }
+    return error;
+}
+
+static void TestSteps(TrigPrecision precision, double bound) {
+    
+    const int stepCounts[] = { 3, 4, 7, 8, 32, 100, 1000, 4099 };
+    for (unsigned n = 0; n < sizeof(stepCounts) / sizeof(stepCounts[0]); ++n) {
+        
+        int steps = stepCounts[n];
+        vector<float> s(steps + 1), c(steps + 1);
+        SinCosSteps(steps, &s[0], &c[0], steps + 1, precision);
+        
+        // The ring closes exactly, and slices mirrored across the x axis match
+        CHECK(s[steps] == s[0] && c[steps] == c[0]);
+        CHECK(s[0] == 0 && c[0] == 1);
+        for (int k = 1; k < steps; ++k) {
+            CHECK(s[k] == -s[steps - k] && c[k] == c[steps - k]);
+        }
+        
+        // Quarter turns are exact
+        if (steps % 4 == 0) {
+            
+            CHECK(s[steps / 4] == 1 && c[steps / 4] == 0);
+            CHECK(s[steps / 2] == 0 && c[steps / 2] == -1);
+            CHECK(s[3 * steps / 4] == -1 && c[3 * steps / 4] == 0);
+        }
+        
+        for (int k = 0; k <= steps; ++k) {
+            
+            double angle = k * 2 * M_PI / steps;
+            CHECK(fabs(s[k] - sin(angle)) < bound && fabs(c[k] - cos(angle)) < bound);
+        }
+    }
+}
+
+int main() {
+    
+    double accurate = MaxError(TrigPrecisionAccurate);
+    double fast = MaxError(TrigPrecisionFast);
+    printf("max error for |x| < %g: accurate %g, fast %g\n", Range, accurate, fast);
+    CHECK(accurate < 1e-7);
+    CHECK(fast < 2e-5);
+    
+    TestSteps(TrigPrecisionAccurate, 1e-7);
+    TestSteps(TrigPrecisionFast, 2e-5);
+    return CheckResult();
+}
@@ -0,0 +1,145 @@
+//
+//  VertexFormatTests.cpp
+//  TouchConeTests
+//
+//  Created by zhangdl on 5/6/14.
+//  Copyright (c) 2014 com.*. All rights reserved.
+//
+//  Round trips through the packed vertex component types of Vector.hpp:
+//  every half, every snorm16 and unorm8 code, and the octahedral normal
+//  encoding on random directions.  The batch half conversions are checked
+//  against the scalar ones, so the SSE and NEON paths are covered wherever
+//  they're built.
+//
+
+#include <cmath>
+#include <cstring>
+#include <vector>
+#include "Check.hpp"
+#include "Vector.hpp"
+
+using namespace std;
+
+static bool IsNan(half h) {
+    
+    return (h & 0x7c00) == 0x7c00 && (h & 0x3ff);
+}
+
+static void TestHalf() {
+    
+    // Every half survives the trip through float; NaNs stay NaNs
+    vector<half> halves(65536), back(65536);
+    vector<float> floats(65536);
+    for (int i = 0; i < 65536; ++i) {
+        halves[i] = (half) i;
+    }
+    HalfToFloat(&halves[0], &floats[0], halves.size());
+    FloatToHalf(&floats[0], &back[0], floats.size());
+    int mismatches = 0, batchMismatches = 0;
+    for (int i = 0; i < 65536; ++i) {
+        
+        half h = halves[i];
+        float f = HalfToFloat(h);
+        if (memcmp(&f, &floats[i], sizeof(f)) && !(IsNan(h) && f != f && floats[i] != floats[i]))
+            ++batchMismatches;
+        if (IsNan(h) ? !IsNan(FloatToHalf(f)) || !IsNan(back[i]) : FloatToHalf(f) != h || back[i] != h)
+            ++mismatches;
+    }
+    CHECK(mismatches == 0);
+    CHECK(batchMismatches == 0);
+    
+    // Floats between halves go to the nearest one, ties to even
+    CHECK(FloatToHalf(1 + 1.0f / 2048) == 0x3c00);
+    CHECK(FloatToHalf(1 + 3.0f / 2048) == 0x3c02);
+    CHECK(FloatToHalf(65519.0f) == 0x7bff);
+    CHECK(FloatToHalf(65520.0f) == 0x7c00);
+    CHECK(FloatToHalf(-1e10f) == 0xfc00);
+    CHECK(FloatToHalf(1e-10f) == 0);
+    
+    CheckRandom random;
+    vector<float> values(10001);
+    for (size_t i = 0; i < values.size(); ++i) {
+        values[i] = random.Float(-70000, 70000) / (float) (1 << (random.Next() % 24));
+    }
+    vector<half> packed(values.size());
+    FloatToHalf(&values[0], &packed[0], values.size());
+    int farther = 0;
+    batchMismatches = 0;
+    for (size_t i = 0; i < values.size(); ++i) {
+        
+        half h = FloatToHalf(values[i]);
+        batchMismatches += packed[i] != h;
+        if ((h & 0x7fff) >= 0x7c00)
+            continue;
+        
+        // No other half is closer than the one picked
+        float error = fabs(HalfToFloat(h) - values[i]);
+        half below = h - 1, above = h + 1;
+        if (((below & 0x7fff) != 0x7fff && fabs(HalfToFloat(below) - values[i]) < error) ||
+            ((above & 0x7fff) < 0x7c00 && (above & 0x7fff) && fabs(HalfToFloat(above) - values[i]) < error))
+            ++farther;
+    }
+    CHECK(batchMismatches == 0);
+    CHECK(farther == 0);
+}
+
+static void TestNormalized() {
+    
+    int mismatches = 0;
+    for (int c = 0; c < 256; ++c) {
+        mismatches += PackUnorm8(c / 255.0f) != c;
+    }
+    for (int c = -32767; c <= 32767; ++c) {
+        mismatches += PackSnorm16(c / 32767.0f) != c;
+    }
+    CHECK(mismatches == 0);
+    CHECK(PackUnorm8(-0.5f) == 0);
+    CHECK(PackUnorm8(2) == 255);
+    CHECK(PackSnorm16(-2) == -32767);
+    CHECK(PackSnorm16(2) == 32767);
+}
+
+// In degrees.  acos of the dot product loses everything near 0, where these
+// errors are, to the rounding of the unit vectors' lengths.
+static double Angle(const vec3& a, const vec3& b) {
+    
+    double cx = (double) a.y * b.z - (double) a.z * b.y;
+    double cy = (double) a.z * b.x - (double) a.x * b.z;
+    double cz = (double) a.x * b.y - (double) a.y * b.x;
+    double dot = (double) a.x * b.x + (double) a.y * b.y + (double) a.z * b.z;
+    return atan2(sqrt(cx * cx + cy * cy + cz * cz), dot) * 180 / 3.14159265358979;
+}
+
+static void TestOctahedral() {
+    
+    // The documented bound is 0.004 degrees
+    CheckRandom random;
+    double worst = 0;
+    for (int i = 0; i < 100000; ++i) {
+        
+        vec3 n(random.Float(-1, 1), random.Float(-1, 1), random.Float(-1, 1));
+        if (n.Dot(n) < 0.01f || n.Dot(n) > 1)
+            continue;
+        n.Normalize();
+        worst = fmax(worst, Angle(n, UnpackOctahedral(PackOctahedral(n))));
+    }
+    
+    // The axes, where the unfolding is discontinuous
+    const vec3 axes[] = {
+        vec3(1, 0, 0), vec3(-1, 0, 0), vec3(0, 1, 0), vec3(0, -1, 0), vec3(0, 0, 1), vec3(0, 0, -1),
+    };
+    for (int i = 0; i < 6; ++i) {
+        
+        worst = fmax(worst, Angle(axes[i], UnpackOctahedral(PackOctahedral(axes[i]))));
+    }
+    printf("octahedral: worst error %.2g degrees\n", worst);
+    CHECK(worst < 0.004);
+}
+
+int main() {
+    
+    TestHalf();
+    TestNormalized();
+    TestOctahedral();
+    return CheckResult();
+}